@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+"""Measures the compile time and the peak memory usage of the compiler for ctcs::compress().
+
+For each literal size, generates a translation unit that compresses an English-like text of that
+size with the given compressor, compiles it, and prints a CSV line:
+size,compressor,seconds,peak_rss_kb
+
+Example:
+  python3 compile_time_bench.py --compiler g++ --include ../include --sizes 4096 16384 65536
+"""
+
+import argparse
+import os
+import random
+import resource
+import subprocess
+import sys
+import tempfile
+import time
+
+WORDS = (
+    "the of and to in a is that for it as was with be by on not he I this are or his from at which "
+    "but have an they you were her she there been one all we their has would when if so no will more "
+    "out up into do any your what some can only other time could"
+).split()
+
+
+def generate_text(size, seed):
+    rng = random.Random(seed)
+    lines = []
+    total = 0
+    while total < size:
+        line = " ".join(rng.choice(WORDS) for _ in range(12)) + "\n"
+        lines.append(line)
+        total += len(line)
+    return "".join(lines)[:size]
+
+
+def generate_source(text, compressor):
+    # Split the text into short literals: some compilers limit the length of a single literal.
+    chunks = [text[i:i + 64] for i in range(0, len(text), 64)]
+    literal = "\n".join('  "' + chunk.replace("\\", "\\\\").replace('"', '\\"').replace("\n", "\\n") + '"'
+                        for chunk in chunks)
+    return (
+        "#include <ctcs/ctcs.h>\n"
+        "\n"
+        "constexpr auto kCompressed = ctcs::compress<\n"
+        f"{literal}\n"
+        f", {compressor}>();\n"
+        "\n"
+        "int main()\n"
+        "{\n"
+        "  return static_cast<int>(kCompressed.decompress().size() & 1);\n"
+        "}\n"
+    )
+
+
+def compile_once(args, source_path):
+    command = [args.compiler, f"-std={args.std}", f"-I{args.include}", "-c", source_path,
+               "-o", os.devnull] + args.flags
+    before = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    start = time.perf_counter()
+    result = subprocess.run(command, capture_output=True, text=True)
+    elapsed = time.perf_counter() - start
+    # ru_maxrss is the maximum over all children, so it is only meaningful if it has grown.
+    peak = resource.getrusage(resource.RUSAGE_CHILDREN).ru_maxrss
+    if result.returncode != 0:
+        errors = [line for line in result.stderr.splitlines() if "error" in line]
+        sys.stderr.write((errors[0] if errors else result.stderr)[:500] + "\n")
+        return None
+    return elapsed, (peak if peak > before else before)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--compiler", default="c++", help="C++ compiler to use")
+    parser.add_argument("--include", required=True, help="path to the ctcs include directory")
+    parser.add_argument("--std", default="c++20", help="C++ standard")
+    parser.add_argument("--sizes", type=int, nargs="+", default=[1024, 4096, 16384, 65536],
+                        help="sizes of the literals, in bytes")
+    parser.add_argument("--compressors", nargs="+",
+                        default=["ctcs::ArithmeticCodingCompressor<ctcs::EnglishCharModel>"],
+                        help="compressors to benchmark")
+    parser.add_argument("--flags", nargs=argparse.REMAINDER, default=[],
+                        help="extra compiler flags, e.g. -fconstexpr-ops-limit=4294967296")
+    args = parser.parse_args()
+
+    print("size,compressor,seconds,peak_rss_kb")
+    with tempfile.TemporaryDirectory() as directory:
+        # Each compilation runs in a separate process, so sort by size: ru_maxrss only grows.
+        for size in sorted(args.sizes):
+            text = generate_text(size, seed=size)
+            for compressor in args.compressors:
+                source_path = os.path.join(directory, "bench.cpp")
+                with open(source_path, "w") as source:
+                    source.write(generate_source(text, compressor))
+                measurement = compile_once(args, source_path)
+                if measurement is None:
+                    print(f'{size},"{compressor}",failed,failed')
+                else:
+                    print(f'{size},"{compressor}",{measurement[0]:.2f},{measurement[1]}')
+                sys.stdout.flush()
+
+
+if __name__ == "__main__":
+    main()
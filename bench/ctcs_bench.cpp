@@ -0,0 +1,460 @@
+// Decompression throughput benchmark.
+//
+// Compresses a few typical inputs at runtime with every compressor/model combination, and measures
+// how fast they are decompressed into a preallocated buffer. The results are printed as CSV (default)
+// or JSON, one record per combination:
+//   version,compressor,model,input,input_bytes,compressed_bytes,mb_per_s,ns_per_char,allocs_per_call
+//
+// With --compress, the compression speed is measured instead: ArithmeticCodingCompressor (as used
+// by ctcs::compress()) vs ArithmeticCodingRuntimeCompressor, for every model.
+//
+// Usage:
+//   ctcs_bench [--compress] [--format csv|json] [--min-time SECONDS] [--size BYTES]
+//
+// Build with optimizations (e.g., CMAKE_BUILD_TYPE=Release) to get meaningful numbers.
+#include <ctcs/ctcs.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef CTCS_BENCH_VERSION
+#define CTCS_BENCH_VERSION "unknown"
+#endif
+
+namespace
+{
+  // The number of calls to the global operator new since the start of the program.
+  std::atomic<std::size_t> g_num_allocations = 0;
+}
+
+// GCC doesn't know that operator new below is a wrapper for malloc(), and warns about calling free()
+// once both functions have been inlined.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size)
+{
+  g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* ptr = std::malloc(size == 0 ? 1 : size))
+  {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+  // Input for the benchmark: one or more strings, each of which is compressed separately.
+  struct Input
+  {
+    const char* name;
+    std::vector<std::string> pieces;
+  };
+
+  // Options from the command line.
+  struct Options
+  {
+    bool json = false;
+    bool compress = false;
+    double min_time = 0.2;
+    std::size_t size = 64 * 1024;
+  };
+
+  // The result of a single benchmark.
+  struct Result
+  {
+    const char* compressor;
+    const char* model;
+    const char* input;
+    std::size_t input_bytes;
+    std::size_t compressed_bytes;
+    double mb_per_s;
+    double ns_per_char;
+    double allocs_per_call;
+  };
+
+  constexpr std::string_view kWords[] = {
+    "the", "of", "and", "to", "in", "a", "is", "that", "for", "it", "as", "was", "with", "be", "by", "on",
+    "not", "he", "this", "are", "or", "his", "from", "at", "which", "but", "have", "an", "they", "you",
+    "were", "her", "she", "there", "been", "one", "all", "we", "their", "has", "would", "when", "if",
+    "so", "no", "will", "more", "out", "up", "into", "do", "any", "your", "what", "some", "can", "only",
+    "other", "time", "could", "people", "about", "between", "through", "because", "without", "language",
+    "compression", "string", "program", "compiler", "memory", "morning", "question", "government"
+  };
+
+  std::string makeEnglish(std::size_t size, std::mt19937& rng)
+  {
+    std::string text;
+    while (text.size() < size)
+    {
+      const std::size_t num_words = 4 + rng() % 16;
+      for (std::size_t i = 0; i < num_words; ++i)
+      {
+        std::string word(kWords[rng() % std::size(kWords)]);
+        if (i == 0)
+        {
+          word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        }
+        else
+        {
+          text += (rng() % 10 == 0) ? ", " : " ";
+        }
+        text += word;
+      }
+      text += (rng() % 8 == 0) ? ".\n\n" : ". ";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  std::string makeJson(std::size_t size, std::mt19937& rng)
+  {
+    std::string text = "[\n";
+    for (std::size_t id = 1; text.size() < size; ++id)
+    {
+      const std::string name(kWords[rng() % std::size(kWords)]);
+      text += "  {\n";
+      text += "    \"id\": " + std::to_string(id) + ",\n";
+      text += "    \"name\": \"" + name + std::to_string(rng() % 1000) + "\",\n";
+      text += "    \"email\": \"" + name + "@example.com\",\n";
+      text += std::string("    \"active\": ") + ((rng() % 2) ? "true" : "false") + ",\n";
+      text += "    \"score\": " + std::to_string(rng() % 10000) + "." + std::to_string(rng() % 100) + ",\n";
+      text += "    \"tags\": [\"" + std::string(kWords[rng() % std::size(kWords)]) + "\", \"" +
+              std::string(kWords[rng() % std::size(kWords)]) + "\"]\n";
+      text += "  },\n";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  std::string makeCode(std::size_t size, std::mt19937& rng)
+  {
+    constexpr std::string_view kTypes[] = { "int", "std::size_t", "bool", "double", "std::string" };
+    std::string text = "#include <string>\n#include <vector>\n\n";
+    while (text.size() < size)
+    {
+      const std::string name(kWords[rng() % std::size(kWords)]);
+      const std::string type(kTypes[rng() % std::size(kTypes)]);
+      text += "// Returns the " + name + " of the given items.\n";
+      text += type + " get_" + name + "(const std::vector<" + type + ">& items)\n{\n";
+      text += "  " + type + " result{};\n";
+      text += "  for (std::size_t i = 0; i < items.size(); ++i)\n  {\n";
+      text += "    if (items[i] != result)\n    {\n";
+      text += "      result = items[i];\n";
+      text += "    }\n  }\n";
+      text += "  return result;\n}\n\n";
+    }
+    text.resize(size);
+    return text;
+  }
+
+  std::string makeRandom(std::size_t size, std::mt19937& rng)
+  {
+    std::string text(size, '\0');
+    for (char& c : text)
+    {
+      c = static_cast<char>(rng() & 0xFF);
+    }
+    return text;
+  }
+
+  std::vector<Input> makeInputs(std::size_t size)
+  {
+    std::mt19937 rng(42);
+    std::vector<Input> inputs;
+    inputs.push_back({ "english", { makeEnglish(size, rng) } });
+    inputs.push_back({ "json", { makeJson(size, rng) } });
+    inputs.push_back({ "code", { makeCode(size, rng) } });
+    inputs.push_back({ "random", { makeRandom(size, rng) } });
+    inputs.push_back({ "short", {
+      "OK", "Cancel", "Hello, World!", "File not found.", "Access denied.", "Are you sure?",
+      "Invalid argument: expected a positive number.", "Connection timed out.", "Saving...",
+      "The operation completed successfully.", "Out of memory.", "Press any key to continue."
+    } });
+    return inputs;
+  }
+
+  // The result of measure().
+  struct Measurement
+  {
+    std::size_t num_iterations;
+    double seconds;
+    std::size_t num_allocations;
+  };
+
+  // Calls the given function repeatedly, doubling the number of iterations until the measurement
+  // takes long enough.
+  template<class Function>
+  Measurement measure(Function function, const Options& options)
+  {
+    std::size_t num_iterations = 1;
+    while (true)
+    {
+      const std::size_t allocations_before = g_num_allocations.load(std::memory_order_relaxed);
+      const auto start = std::chrono::steady_clock::now();
+      for (std::size_t i = 0; i < num_iterations; ++i)
+      {
+        function();
+      }
+      const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      const std::size_t num_allocations = g_num_allocations.load(std::memory_order_relaxed) - allocations_before;
+      if (seconds >= options.min_time)
+      {
+        return Measurement{ num_iterations, seconds, num_allocations };
+      }
+      num_iterations *= 2;
+    }
+  }
+
+  Result makeResult(const char* compressor_name, const char* model_name, const Input& input,
+                    std::size_t compressed_bytes, const Measurement& measurement)
+  {
+    std::size_t input_bytes = 0;
+    for (const std::string& piece : input.pieces)
+    {
+      input_bytes += piece.size();
+    }
+    const double num_chars = static_cast<double>(input_bytes) * static_cast<double>(measurement.num_iterations);
+    const double num_calls = static_cast<double>(input.pieces.size()) * static_cast<double>(measurement.num_iterations);
+    return Result{
+      compressor_name,
+      model_name,
+      input.name,
+      input_bytes,
+      compressed_bytes,
+      num_chars / measurement.seconds / 1e6,
+      measurement.seconds * 1e9 / num_chars,
+      static_cast<double>(measurement.num_allocations) / num_calls
+    };
+  }
+
+  // Measures the decompression of the given input with the given compressor, and appends the result.
+  // \return false if the decompressed data doesn't match the input, true otherwise.
+  template<class Compressor>
+  bool runBenchmark(const char* compressor_name, const char* model_name, const Input& input,
+                    const Options& options, std::vector<Result>& results)
+  {
+    using Decompressor = typename Compressor::Decompressor;
+    std::vector<std::string> compressed;
+    std::vector<std::string> decompressed;
+    std::size_t input_bytes = 0;
+    std::size_t compressed_bytes = 0;
+    for (const std::string& piece : input.pieces)
+    {
+      compressed.push_back(Compressor{}(piece));
+      decompressed.emplace_back(piece.size(), '\0');
+      input_bytes += piece.size();
+      compressed_bytes += compressed.back().size();
+    }
+    const auto decompressAll = [&]()
+    {
+      for (std::size_t i = 0; i < compressed.size(); ++i)
+      {
+        Decompressor{}(compressed[i], std::span<char>(decompressed[i]));
+      }
+    };
+
+    // Warm up, and check that the data survives the round trip.
+    decompressAll();
+    if (decompressed != input.pieces)
+    {
+      std::fprintf(stderr, "%s<%s> failed to decompress '%s'.\n", compressor_name, model_name, input.name);
+      return false;
+    }
+
+    const Measurement measurement = measure(decompressAll, options);
+    results.push_back(makeResult(compressor_name, model_name, input, compressed_bytes, measurement));
+    return true;
+  }
+
+  // Measures the compression of the given input with the given compressor, and appends the result.
+  // \param compress - function that compresses a string into the given buffer.
+  // \return false if the compressed data doesn't match ctcs::compress(), true otherwise.
+  template<class Model, class CompressFunction>
+  bool runCompressionBenchmark(const char* compressor_name, const char* model_name, const Input& input,
+                               const Options& options, CompressFunction compress, std::vector<Result>& results)
+  {
+    std::vector<std::string> compressed(input.pieces.size());
+    const auto compressAll = [&]()
+    {
+      for (std::size_t i = 0; i < input.pieces.size(); ++i)
+      {
+        compressed[i].clear();
+        compress(input.pieces[i], compressed[i]);
+      }
+    };
+
+    // Warm up, and check that the output is the same as the one of ctcs::compress().
+    compressAll();
+    std::size_t compressed_bytes = 0;
+    for (std::size_t i = 0; i < input.pieces.size(); ++i)
+    {
+      if (compressed[i] != ctcs::ArithmeticCodingCompressor<Model>{}(input.pieces[i]))
+      {
+        std::fprintf(stderr, "%s<%s> produced different data for '%s'.\n", compressor_name, model_name, input.name);
+        return false;
+      }
+      compressed_bytes += compressed[i].size();
+    }
+
+    const Measurement measurement = measure(compressAll, options);
+    results.push_back(makeResult(compressor_name, model_name, input, compressed_bytes, measurement));
+    return true;
+  }
+
+  template<class Model>
+  bool runCompressionBenchmarks(const char* model_name, const Input& input, const Options& options,
+                                std::vector<Result>& results)
+  {
+    ctcs::ArithmeticCodingRuntimeCompressor<Model> runtime_compressor;
+    return runCompressionBenchmark<Model>("ArithmeticCoding", model_name, input, options,
+                                          [](const std::string& data, std::string& dest)
+                                          {
+                                            dest = ctcs::ArithmeticCodingCompressor<Model>{}(data);
+                                          }, results) &&
+           runCompressionBenchmark<Model>("ArithmeticCodingRuntime", model_name, input, options,
+                                          [&runtime_compressor](const std::string& data, std::string& dest)
+                                          {
+                                            runtime_compressor.compress(data, dest);
+                                          }, results);
+  }
+
+  // Runs the benchmarks for every compressor/model combination on the given input.
+  bool runAll(const Input& input, const Options& options, std::vector<Result>& results)
+  {
+    using ctcs::AdaptiveCharModel;
+    using ctcs::ContextModel;
+    using ctcs::EnglishCharModel;
+    if (options.compress)
+    {
+      return runCompressionBenchmarks<EnglishCharModel>("EnglishCharModel", input, options, results) &&
+             runCompressionBenchmarks<AdaptiveCharModel>("AdaptiveCharModel", input, options, results) &&
+             runCompressionBenchmarks<ContextModel<1>>("ContextModel<1>", input, options, results) &&
+             runCompressionBenchmarks<ContextModel<2>>("ContextModel<2>", input, options, results) &&
+             runCompressionBenchmarks<ctcs::Utf8Model<>>("Utf8Model", input, options, results);
+    }
+    return runBenchmark<ctcs::ArithmeticCodingCompressor<EnglishCharModel>>("ArithmeticCoding", "EnglishCharModel", input, options, results) &&
+           runBenchmark<ctcs::ArithmeticCodingCompressor<AdaptiveCharModel>>("ArithmeticCoding", "AdaptiveCharModel", input, options, results) &&
+           runBenchmark<ctcs::ArithmeticCodingCompressor<ContextModel<1>>>("ArithmeticCoding", "ContextModel<1>", input, options, results) &&
+           runBenchmark<ctcs::ArithmeticCodingCompressor<ContextModel<2>>>("ArithmeticCoding", "ContextModel<2>", input, options, results) &&
+           runBenchmark<ctcs::RangeCodingCompressor<EnglishCharModel>>("RangeCoding", "EnglishCharModel", input, options, results) &&
+           runBenchmark<ctcs::RangeCodingCompressor<AdaptiveCharModel>>("RangeCoding", "AdaptiveCharModel", input, options, results) &&
+           runBenchmark<ctcs::RangeCodingCompressor<ContextModel<1>>>("RangeCoding", "ContextModel<1>", input, options, results) &&
+           runBenchmark<ctcs::InterleavedRangeCodingCompressor<EnglishCharModel, 2>>("InterleavedRangeCoding<2>", "EnglishCharModel", input, options, results) &&
+           runBenchmark<ctcs::InterleavedRangeCodingCompressor<EnglishCharModel, 4>>("InterleavedRangeCoding<4>", "EnglishCharModel", input, options, results) &&
+           runBenchmark<ctcs::HuffmanCompressor<EnglishCharModel>>("Huffman", "EnglishCharModel", input, options, results) &&
+           runBenchmark<ctcs::LzCompressor<EnglishCharModel>>("Lz", "EnglishCharModel", input, options, results);
+  }
+
+  void printCsv(const std::vector<Result>& results)
+  {
+    std::printf("version,compressor,model,input,input_bytes,compressed_bytes,mb_per_s,ns_per_char,allocs_per_call\n");
+    for (const Result& r : results)
+    {
+      std::printf("%s,%s,%s,%s,%zu,%zu,%.2f,%.3f,%.2f\n", CTCS_BENCH_VERSION, r.compressor, r.model, r.input,
+                  r.input_bytes, r.compressed_bytes, r.mb_per_s, r.ns_per_char, r.allocs_per_call);
+    }
+  }
+
+  void printJson(const std::vector<Result>& results)
+  {
+#ifdef NDEBUG
+    constexpr const char* kBuild = "release";
+#else
+    constexpr const char* kBuild = "debug";
+#endif
+    std::printf("{\n  \"version\": \"%s\",\n  \"build\": \"%s\",\n  \"results\": [\n", CTCS_BENCH_VERSION, kBuild);
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+      const Result& r = results[i];
+      std::printf("    {\"compressor\": \"%s\", \"model\": \"%s\", \"input\": \"%s\", \"input_bytes\": %zu, "
+                  "\"compressed_bytes\": %zu, \"mb_per_s\": %.2f, \"ns_per_char\": %.3f, \"allocs_per_call\": %.2f}%s\n",
+                  r.compressor, r.model, r.input, r.input_bytes, r.compressed_bytes, r.mb_per_s, r.ns_per_char,
+                  r.allocs_per_call, (i + 1 < results.size()) ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string_view arg = argv[i];
+      const bool has_value = (i + 1 < argc);
+      if (arg == "--compress")
+      {
+        options.compress = true;
+      }
+      else if (arg == "--format" && has_value)
+      {
+        const std::string_view format = argv[++i];
+        if (format != "csv" && format != "json")
+        {
+          return false;
+        }
+        options.json = (format == "json");
+      }
+      else if (arg == "--min-time" && has_value)
+      {
+        options.min_time = std::strtod(argv[++i], nullptr);
+      }
+      else if (arg == "--size" && has_value)
+      {
+        options.size = std::strtoull(argv[++i], nullptr, 10);
+      }
+      else
+      {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::fprintf(stderr, "Usage: %s [--compress] [--format csv|json] [--min-time SECONDS] [--size BYTES]\n", argv[0]);
+    return 2;
+  }
+  std::vector<Result> results;
+  for (const Input& input : makeInputs(options.size))
+  {
+    if (!runAll(input, options, results))
+    {
+      return 1;
+    }
+  }
+  if (options.json)
+  {
+    printJson(results);
+  }
+  else
+  {
+    printCsv(results);
+  }
+  return 0;
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "DecodePolicy.h"
+#include "internal/ArithmeticCoding.h"
+#include "internal/Exceptions.h"
+#include "internal/FenwickTree.h"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace ctcs
+{
+  // Adaptive order-0 ArithmeticCodingModel.
+  //
+  // Starts with the uniform distribution and learns the distribution of the symbols
+  // while encoding/decoding. The cumulative frequencies are stored in a Fenwick tree,
+  // so both the queries and the updates take O(log NumSymbols) time.
+  // \param CharT - type of a symbol.
+  // \param NumSymbols - the number of symbols in the alphabet. The symbols are expected to be
+  //        [0; NumSymbols), where signed characters are reinterpreted as unsigned ones.
+  template<class CharT, std::size_t NumSymbols = 256>
+  class AdaptiveModel
+  {
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+    using char_type = CharT;
+
+    static_assert(NumSymbols > 1, "NumSymbols must be greater than 1.");
+
+    // Constructs a model where all symbols are equally likely.
+    constexpr AdaptiveModel() noexcept;
+
+    // Constructs a model with the given initial distribution.
+    // \param initial_frequencies - the initial frequency of each symbol.
+    // \throw std::invalid_argument if some frequency is 0, or if the total exceeds kMaxTotal.
+    explicit constexpr AdaptiveModel(std::span<const FrequencyCount, NumSymbols> initial_frequencies);
+
+    constexpr FrequencyCount scalingFactor() const noexcept
+    {
+      return total_;
+    }
+
+    // Find the symbol, whose interval [lower, upper) contains the specified value.
+    constexpr char_type getCharByPoint(FrequencyCount value) const
+    {
+      return decodeSymbol(value).symbol;
+    }
+
+    // Find the symbol, whose interval [lower, upper) contains the specified value.
+    // \return the symbol and its interval.
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value) const
+    {
+      return decodeSymbol(value, CheckedDecode{});
+    }
+
+    // Same as above, but with TrustedDecode the value is trusted to be less than scalingFactor(),
+    // and isn't checked.
+    template<DecodePolicy Policy>
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value, Policy) const;
+
+    // Returns the interval for the specified symbol.
+    constexpr std::pair<FrequencyCount, FrequencyCount> getInterval(char_type symbol) const;
+
+    // Updates the model after encoding/decoding the specified symbol.
+    constexpr void update(char_type symbol);
+
+    // The frequency of a symbol is increased by this value every time the symbol occurs.
+    static constexpr FrequencyCount kIncrement = 32;
+    // The frequencies are halved when the total exceeds this value, so that
+    // the model keeps adapting to the recent statistics. Public, since the total of the
+    // initial frequencies passed to the constructor must not exceed it.
+    static constexpr FrequencyCount kMaxTotal = FrequencyCount{ 1 } << 16;
+
+  private:
+    static_assert(NumSymbols + kIncrement <= kMaxTotal, "NumSymbols is too big.");
+
+    static constexpr std::size_t toIndex(char_type symbol);
+
+    // Halves the frequencies and rebuilds the Fenwick tree.
+    constexpr void rescale() noexcept;
+
+    // The frequency of each symbol.
+    std::array<FrequencyCount, NumSymbols> frequencies_{};
+    // Cumulative frequencies.
+    Detail_NS::FenwickTree<FrequencyCount, NumSymbols> cumulative_frequencies_;
+    // The sum of all frequencies.
+    FrequencyCount total_ = NumSymbols;
+  };
+
+  // Adaptive order-0 model for encoding char elements.
+  using AdaptiveCharModel = AdaptiveModel<char>;
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr AdaptiveModel<CharT, NumSymbols>::AdaptiveModel() noexcept
+  {
+    frequencies_.fill(1);
+    cumulative_frequencies_ = Detail_NS::FenwickTree<FrequencyCount, NumSymbols>(
+      std::span<const FrequencyCount, NumSymbols>(frequencies_));
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr AdaptiveModel<CharT, NumSymbols>::AdaptiveModel(
+    std::span<const FrequencyCount, NumSymbols> initial_frequencies)
+  {
+    total_ = 0;
+    for (std::size_t i = 0; i < NumSymbols; ++i)
+    {
+      if (initial_frequencies[i] == 0)
+      {
+        CTCS_THROW(std::invalid_argument("AdaptiveModel(): all frequencies must be positive."));
+      }
+      frequencies_[i] = initial_frequencies[i];
+      total_ += initial_frequencies[i];
+      if (total_ > kMaxTotal)
+      {
+        CTCS_THROW(std::invalid_argument("AdaptiveModel(): the total frequency is too big."));
+      }
+    }
+    cumulative_frequencies_ = Detail_NS::FenwickTree<FrequencyCount, NumSymbols>(
+      std::span<const FrequencyCount, NumSymbols>(frequencies_));
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  template<DecodePolicy Policy>
+  constexpr ArithmeticCoding_NS::DecodedSymbol<CharT>
+  AdaptiveModel<CharT, NumSymbols>::decodeSymbol(FrequencyCount value, Policy) const
+  {
+    if constexpr (Policy::kChecked)
+    {
+      if (value >= total_)
+      {
+        CTCS_THROW(std::out_of_range("AdaptiveModel::decodeSymbol(): value is out of range."));
+      }
+    }
+    const Detail_NS::FenwickTreeFindResult<FrequencyCount> found = cumulative_frequencies_.find(value);
+    return { static_cast<char_type>(found.index),
+             { found.prefix_sum, found.prefix_sum + frequencies_[found.index] } };
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr std::pair<typename AdaptiveModel<CharT, NumSymbols>::FrequencyCount,
+                      typename AdaptiveModel<CharT, NumSymbols>::FrequencyCount>
+  AdaptiveModel<CharT, NumSymbols>::getInterval(char_type symbol) const
+  {
+    const std::size_t index = toIndex(symbol);
+    const FrequencyCount lower = cumulative_frequencies_.prefixSum(index);
+    return { lower, lower + frequencies_[index] };
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr void AdaptiveModel<CharT, NumSymbols>::update(char_type symbol)
+  {
+    const std::size_t index = toIndex(symbol);
+    frequencies_[index] += kIncrement;
+    cumulative_frequencies_.add(index, kIncrement);
+    total_ += kIncrement;
+    if (total_ > kMaxTotal)
+    {
+      rescale();
+    }
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr std::size_t AdaptiveModel<CharT, NumSymbols>::toIndex(char_type symbol)
+  {
+    std::size_t index = 0;
+    if constexpr (std::is_integral_v<char_type> && sizeof(char_type) == 1)
+    {
+      index = static_cast<unsigned char>(symbol);
+    }
+    else
+    {
+      index = static_cast<std::size_t>(symbol);
+    }
+    if (index >= NumSymbols)
+    {
+      CTCS_THROW(std::out_of_range("AdaptiveModel: symbol is out of range."));
+    }
+    return index;
+  }
+
+  template<class CharT, std::size_t NumSymbols>
+  constexpr void AdaptiveModel<CharT, NumSymbols>::rescale() noexcept
+  {
+    total_ = 0;
+    for (FrequencyCount& frequency : frequencies_)
+    {
+      frequency = (frequency + 1) / 2;
+      total_ += frequency;
+    }
+    cumulative_frequencies_ = Detail_NS::FenwickTree<FrequencyCount, NumSymbols>(
+      std::span<const FrequencyCount, NumSymbols>(frequencies_));
+  }
+}
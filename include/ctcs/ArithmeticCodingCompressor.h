@@ -1,15 +1,72 @@
 #pragma once
 
+#include "DecodePolicy.h"
+#include "DecompressionStream.h"
 #include "internal/ArithmeticCoder.h"
 #include "internal/ArithmeticDecoder.h"
+#include "internal/Exceptions.h"
 #include "internal/VarInt.h"
 
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
 namespace ctcs
 {
+  namespace Detail_NS
+  {
+    // Decodes the data encoded via arithmetic coding one character at a time.
+    // \param Policy - CheckedDecode, or TrustedDecode if the data is known to be valid.
+    template<ArithmeticCoding_NS::ArithmeticCodingModel Model, DecodePolicy Policy = CheckedDecode>
+    class ArithmeticCodingSymbolDecoder
+    {
+    public:
+      // \param compressed_data - the encoded data, without the header.
+      explicit constexpr ArithmeticCodingSymbolDecoder(std::string_view compressed_data):
+        bit_stream_(compressed_data.data(), compressed_data.size()),
+        decoder_(bit_stream_)
+      {}
+
+      // Non-copyable, non-movable: decoder_ refers to bit_stream_.
+      ArithmeticCodingSymbolDecoder(const ArithmeticCodingSymbolDecoder&) = delete;
+      ArithmeticCodingSymbolDecoder(ArithmeticCodingSymbolDecoder&&) = delete;
+      ArithmeticCodingSymbolDecoder& operator=(const ArithmeticCodingSymbolDecoder&) = delete;
+      ArithmeticCodingSymbolDecoder& operator=(ArithmeticCodingSymbolDecoder&&) = delete;
+
+      constexpr ~ArithmeticCodingSymbolDecoder() = default;
+
+      // Decodes the next character.
+      constexpr char decode()
+      {
+        const char c = decoder_.decode(model_);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model_.update(c);
+        }
+        return c;
+      }
+
+    private:
+      ArithmeticCoding_NS::IBitStream bit_stream_;
+      ArithmeticCoding_NS::BasicArithmeticDecoder<Policy> decoder_;
+      Model model_ {};
+    };
+  }
+
   template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
   class ArithmeticCodingDecompressor
   {
   public:
+    // Incremental decompressor.
+    using Stream = DecompressionStream<Detail_NS::ArithmeticCodingSymbolDecoder<Model>>;
+    // Incremental decompressor for the data that is known to be valid (see TrustedDecode).
+    using TrustedStream =
+      DecompressionStream<Detail_NS::ArithmeticCodingSymbolDecoder<Model, TrustedDecode>, TrustedDecode>;
+
+    // Decompresses the data and appends it to the given std::string.
     constexpr void operator()(std::string_view compressed_data, std::string& dest)
     {
       // Special case: empty string is decompressed into an empty string.
@@ -17,21 +74,51 @@ namespace ctcs
       {
         return;
       }
+      const std::size_t offset = dest.size();
+      dest.resize(offset + Detail_NS::readVarInt(compressed_data).value);
+      (*this)(compressed_data, std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      return (*this)(compressed_data, dest, CheckedDecode{});
+    }
+
+    // Decompresses the data into the given buffer with the given DecodePolicy.
+    // With TrustedDecode, the data is not checked; the size of the buffer still is, since it
+    // doesn't come from the data.
+    template<DecodePolicy Policy>
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest, Policy)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
       // Read the size of the decompressed data.
-      const Detail_NS::ReadVarIntResult read__size_result = Detail_NS::readVarInt(compressed_data);
-      const std::size_t decompressed_data_size = read__size_result.value;
+      const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt<Policy::kChecked>(compressed_data);
+      const std::size_t decompressed_data_size = read_size_result.value;
+      if (decompressed_data_size > dest.size())
+      {
+        CTCS_THROW(std::length_error("ArithmeticCodingDecompressor: the buffer is too small."));
+      }
       // Discard the bytes we've just read.
-      compressed_data = compressed_data.substr(read__size_result.num_bytes_read);
-      dest.reserve(dest.size() + decompressed_data_size);
-      ArithmeticCoding_NS::IBitStream bit_stream(compressed_data.data(), compressed_data.size());
-      ArithmeticCoding_NS::ArithmeticDecoder decoder(bit_stream);
-      Model model {};
+      compressed_data.remove_prefix(read_size_result.num_bytes_read);
+      if (decompressed_data_size == 0)
+      {
+        return 0;
+      }
+      Detail_NS::ArithmeticCodingSymbolDecoder<Model, Policy> decoder(compressed_data);
       for (std::size_t i = 0; i < decompressed_data_size; ++i)
       {
-        const char c = decoder.decode(model);
-        dest.push_back(c);
-        // TODO: update the model if it's adaptive.
+        dest[i] = decoder.decode();
       }
+      return decompressed_data_size;
     }
   };
 
@@ -56,13 +143,17 @@ namespace ctcs
       std::string compressed_data;
       // Serialize the size of the uncompressed data.
       Detail_NS::writeVarInt(compressed_data, data.size());
-      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data);
+      // Text usually takes less than 5/8 of its size; the string grows if it doesn't.
+      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data, data.size() / 8 * 5);
       ArithmeticCoding_NS::ArithmeticCoder coder(bit_stream);
       Model model {};
       for (char c : data)
       {
         coder.encode(model, c);
-        // TODO: update hte model if it's adaptive.
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model.update(c);
+        }
       }
       coder.finalize();
       bit_stream.finalize();
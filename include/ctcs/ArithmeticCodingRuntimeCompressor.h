@@ -0,0 +1,87 @@
+#pragma once
+
+#include "ArithmeticCodingCompressor.h"
+#include "internal/BufferedArithmeticCoder.h"
+#include "internal/VarInt.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  // Runtime compressor that produces exactly the same data as ArithmeticCodingCompressor<Model>,
+  // so strings compressed at runtime (cached rendered templates, in-memory logs, etc.) can be
+  // decompressed via ArithmeticCodingDecompressor<Model>, and stored alongside the ones compressed
+  // at compile time.
+  //
+  // ArithmeticCodingCompressor can be called at runtime as well, but it is tuned for constant evaluation.
+  // This class is tuned for the CPU instead:
+  // * The output buffer and the model are reused across calls, and no memory is allocated once
+  //   the buffer is large enough. If Model has a reset() method (e.g. ContextModel, Utf8Model), it is
+  //   called instead of assigning a new model, so only the state touched by the previous call is restored.
+  // * The encoder writes directly into the buffer, and renormalizes in constant time
+  //   (see ArithmeticCoding_NS::BufferedArithmeticCoder).
+  //
+  // The object is not thread-safe: use a separate instance per thread.
+  // \param Model - ArithmeticCodingModel to use.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+  class ArithmeticCodingRuntimeCompressor
+  {
+  public:
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_move_assignable_v<Model> || requires(Model& model) { model.reset(); },
+                  "Model should be move-assignable or provide reset().");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+
+    using Decompressor = ArithmeticCodingDecompressor<Model>;
+
+    // Compresses the data, and appends it to the given std::string.
+    // Doesn't allocate any memory if dest has enough capacity.
+    void compress(std::string_view data, std::string& dest)
+    {
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return;
+      }
+      // Serialize the size of the uncompressed data.
+      Detail_NS::writeVarInt(dest, data.size());
+      if constexpr (requires { model_.reset(); })
+      {
+        model_.reset();
+      }
+      else
+      {
+        model_ = Model{};
+      }
+      // Text usually takes less than half of its size; the buffer grows if it doesn't.
+      ArithmeticCoding_NS::BufferedArithmeticCoder coder(dest, data.size() / 2);
+      coder.encode(model_, data);
+      coder.finalize();
+    }
+
+    // Compresses the data into the internal buffer.
+    // \return the compressed data, valid until the next call to compress() or the destruction of this object.
+    std::string_view compress(std::string_view data)
+    {
+      buffer_.clear();
+      compress(data, buffer_);
+      return buffer_;
+    }
+
+    // Same as ArithmeticCodingCompressor<Model>::operator().
+    std::string operator()(std::string_view data)
+    {
+      std::string result;
+      compress(data, result);
+      return result;
+    }
+
+  private:
+    // The model used by the current call.
+    Model model_{};
+    std::string buffer_;
+  };
+}
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "AdaptiveModel.h"
+#include "LzCompressor.h"
+#include "internal/Exceptions.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // The first byte of the data compressed by BinaryCompressor.
+    enum class BinaryMethod : unsigned char
+    {
+      // The data is stored as is.
+      kStored = 0,
+      // The data is compressed with the inner compressor.
+      kCompressed = 1,
+      // The data is delta-filtered with the stride 1 << (method - kDelta), and then compressed.
+      kDelta = 2
+    };
+
+    // Replaces every byte (except the first stride ones) with its difference from the byte stride positions back.
+    constexpr std::string applyDeltaFilter(std::string_view data, std::size_t stride)
+    {
+      std::string result(data);
+      for (std::size_t i = stride; i < data.size(); ++i)
+      {
+        result[i] = static_cast<char>(static_cast<unsigned char>(data[i]) - static_cast<unsigned char>(data[i - stride]));
+      }
+      return result;
+    }
+
+    // Estimates the order-0 entropy of the data delta-filtered with the given stride, i.e. the size
+    // in bits if every byte were encoded according to the frequencies of the bytes in the filtered data.
+    // The data isn't copied; log2 is approximated piecewise-linearly, which is enough to compare strides.
+    // \param stride - the stride of the delta filter; 0 means the raw data.
+    // \return the estimate in 1/65536ths of a bit.
+    constexpr std::uint64_t estimateDeltaEntropy(std::string_view data, std::size_t stride)
+    {
+      std::array<std::uint64_t, 256> counts{};
+      for (std::size_t i = 0; i < data.size(); ++i)
+      {
+        const unsigned char previous = (stride != 0 && i >= stride) ? static_cast<unsigned char>(data[i - stride]) : 0;
+        ++counts[static_cast<unsigned char>(static_cast<unsigned char>(data[i]) - previous)];
+      }
+      // x * log2(x) in 1/65536ths.
+      const auto xlog2x = [](std::uint64_t x) -> std::uint64_t
+      {
+        if (x == 0)
+        {
+          return 0;
+        }
+        const unsigned int exponent = static_cast<unsigned int>(std::bit_width(x)) - 1;
+        const std::uint64_t log2x = (std::uint64_t{ exponent } << 16) + (((x - (std::uint64_t{ 1 } << exponent)) << 16) >> exponent);
+        return x * log2x;
+      };
+      // sum(count * log2(size / count)) = size * log2(size) - sum(count * log2(count)).
+      std::uint64_t result = xlog2x(data.size());
+      for (const std::uint64_t count : counts)
+      {
+        result -= xlog2x(count);
+      }
+      return result;
+    }
+
+    // Reverts applyDeltaFilter() in place. Does nothing if stride is 0.
+    constexpr void revertDeltaFilter(std::span<char> data, std::size_t stride) noexcept
+    {
+      if (stride == 0)
+      {
+        return;
+      }
+      for (std::size_t i = stride; i < data.size(); ++i)
+      {
+        data[i] = static_cast<char>(static_cast<unsigned char>(data[i]) + static_cast<unsigned char>(data[i - stride]));
+      }
+    }
+  }
+
+  // Decompressor for BinaryCompressor.
+  // \param Decompressor - decompressor for the inner compressor.
+  template<class Decompressor>
+  class BinaryDecompressor
+  {
+  public:
+    // Decompresses the data and appends it to the given std::string.
+    constexpr void operator()(std::string_view compressed_data, std::string& dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return;
+      }
+      const Detail_NS::BinaryMethod method = static_cast<Detail_NS::BinaryMethod>(compressed_data[0]);
+      compressed_data.remove_prefix(1);
+      if (method == Detail_NS::BinaryMethod::kStored)
+      {
+        dest.append(compressed_data);
+        return;
+      }
+      const std::size_t stride = getStride(method);
+      const std::size_t offset = dest.size();
+      Decompressor{}(compressed_data, dest);
+      Detail_NS::revertDeltaFilter(std::span<char>(dest).subspan(offset), stride);
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
+      const Detail_NS::BinaryMethod method = static_cast<Detail_NS::BinaryMethod>(compressed_data[0]);
+      compressed_data.remove_prefix(1);
+      if (method == Detail_NS::BinaryMethod::kStored)
+      {
+        if (compressed_data.size() > dest.size())
+        {
+          CTCS_THROW(std::length_error("BinaryDecompressor: the buffer is too small."));
+        }
+        std::copy(compressed_data.begin(), compressed_data.end(), dest.begin());
+        return compressed_data.size();
+      }
+      const std::size_t stride = getStride(method);
+      const std::size_t size = Decompressor{}(compressed_data, dest);
+      Detail_NS::revertDeltaFilter(dest.first(size), stride);
+      return size;
+    }
+
+  private:
+    // \return the stride of the delta filter for the given method; 0 if the data isn't filtered.
+    // \throw std::logic_error if the method is invalid.
+    static constexpr std::size_t getStride(Detail_NS::BinaryMethod method)
+    {
+      const unsigned int value = static_cast<unsigned char>(method);
+      if (value == static_cast<unsigned char>(Detail_NS::BinaryMethod::kCompressed))
+      {
+        return 0;
+      }
+      constexpr unsigned int kDelta = static_cast<unsigned char>(Detail_NS::BinaryMethod::kDelta);
+      if (value < kDelta || value - kDelta >= 8)
+      {
+        CTCS_THROW(std::logic_error("BinaryDecompressor: invalid method."));
+      }
+      return std::size_t{ 1 } << (value - kDelta);
+    }
+  };
+
+  // Compile-time compressor for binary data: lookup tables, ICC profiles, model weights, etc.
+  //
+  // Picks one of the raw data and the data delta-filtered with the strides 1, 2, 4, ..., MaxDeltaStride
+  // (which turns smooth tables of 8-, 16- or 32-bit numbers into small values) by the estimated
+  // order-0 entropy, and compresses it with the inner compressor. If that doesn't help, the data is
+  // stored as is, so the output is never more than 1 byte larger than the input.
+  //
+  // The inner compressor runs only once, so the delta filters add little to the compile time:
+  // each stride costs a pass over the data. Blobs larger than a few kilobytes may still exceed the
+  // compiler's limit on constant evaluation (-fconstexpr-ops-limit in GCC, -fconstexpr-steps in Clang).
+  // \param Compressor - the inner compressor. The default one replaces repeated fragments with
+  //        references, and encodes the rest with an adaptive model, which doesn't assume anything
+  //        about the distribution of bytes.
+  // \param MaxDeltaStride - the largest stride of the delta filter to consider; 0 disables the filter.
+  template<class Compressor = LzCompressor<AdaptiveCharModel>, std::size_t MaxDeltaStride = 4>
+  class BinaryCompressor
+  {
+  public:
+    static_assert(MaxDeltaStride <= 128, "MaxDeltaStride must not exceed 128.");
+
+    using Decompressor = BinaryDecompressor<typename Compressor::Decompressor>;
+
+    constexpr std::string operator()(std::string_view data)
+    {
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return {};
+      }
+      // Pick the stride whose output looks the most compressible; the raw data wins ties.
+      std::size_t best_stride = 0;
+      std::uint64_t best_entropy = Detail_NS::estimateDeltaEntropy(data, 0);
+      for (std::size_t stride = 1; stride <= MaxDeltaStride && stride < data.size(); stride *= 2)
+      {
+        const std::uint64_t entropy = Detail_NS::estimateDeltaEntropy(data, stride);
+        if (entropy < best_entropy)
+        {
+          best_stride = stride;
+          best_entropy = entropy;
+        }
+      }
+      std::string result;
+      if (best_stride == 0)
+      {
+        result.push_back(static_cast<char>(Detail_NS::BinaryMethod::kCompressed));
+        result.append(Compressor{}(data));
+      }
+      else
+      {
+        const unsigned int log_stride = static_cast<unsigned int>(std::countr_zero(best_stride));
+        result.push_back(static_cast<char>(static_cast<unsigned char>(Detail_NS::BinaryMethod::kDelta) + log_stride));
+        result.append(Compressor{}(Detail_NS::applyDeltaFilter(data, best_stride)));
+      }
+      // Stored data is the fallback.
+      if (result.size() > data.size())
+      {
+        result.assign(1, static_cast<char>(Detail_NS::BinaryMethod::kStored));
+        result.append(data);
+      }
+      return result;
+    }
+  };
+}
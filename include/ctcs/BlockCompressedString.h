@@ -0,0 +1,329 @@
+#pragma once
+
+#include "ArithmeticCodingCompressor.h"
+#include "CompressedStringTable.h"
+#include "EnglishCharModel.h"
+#include "StringLiteral.h"
+#include "internal/CompileTimeBuffer.h"
+#include "internal/Exceptions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  // String compressed at compile time in independently coded blocks.
+  //
+  // The string is split into blocks of BlockSize characters, and every block is encoded from
+  // scratch, starting at a byte boundary. The offsets of the blocks are stored in a checkpoint
+  // table together with the cumulative numbers of newline characters, so that substr(), at()
+  // and line() only decode the blocks they touch. The cost of the random access is a few bytes
+  // per block.
+  // Use ctcs::compressBlocks() to construct objects of this class.
+  // \param Model - ArithmeticCodingModel used to encode the blocks. If the model is adaptive,
+  //        every block is encoded with a fresh instance of the model.
+  // \param BlockSize - the number of characters in a block.
+  // \param CompressedLength - size of the compressed data in bytes.
+  // \param DecompressedLength - size of the decompressed data in bytes.
+  // \param OffsetType - unsigned integer type to store the offsets of the blocks.
+  // \param LineCountType - unsigned integer type to store the numbers of lines.
+  template<class Model, std::size_t BlockSize, std::size_t CompressedLength, std::size_t DecompressedLength,
+           class OffsetType, class LineCountType>
+  class BlockCompressedString
+  {
+  public:
+    static_assert(BlockSize > 0, "BlockSize must be positive.");
+
+    // The number of characters in a block (except, possibly, the last one).
+    static constexpr std::size_t kBlockSize = BlockSize;
+    // The size of the decompressed string.
+    static constexpr std::size_t kDecompressedSize = DecompressedLength;
+    // The number of blocks.
+    static constexpr std::size_t kNumBlocks = (DecompressedLength + BlockSize - 1) / BlockSize;
+    // Special value for substr(), same as std::string::npos.
+    static constexpr std::size_t npos = std::string::npos;
+
+    // \param compressed_data - the encoded blocks.
+    // \param block_offsets - the offset of each block in compressed_data, in bytes.
+    // \param newline_counts - newline_counts[i] is the number of '\n' characters in the blocks [0; i).
+    // \param num_lines - the number of lines in the string.
+    constexpr BlockCompressedString(StringLiteral<CompressedLength> compressed_data,
+                                    std::array<OffsetType, kNumBlocks> block_offsets,
+                                    std::array<LineCountType, kNumBlocks + 1> newline_counts,
+                                    LineCountType num_lines) noexcept:
+      compressed_data_(compressed_data),
+      block_offsets_(block_offsets),
+      newline_counts_(newline_counts),
+      num_lines_(num_lines)
+    {
+    }
+
+    // \return the size of the decompressed string.
+    constexpr std::size_t size() const noexcept
+    {
+      return kDecompressedSize;
+    }
+
+    // \return the number of lines in the string. A line is a sequence of characters terminated
+    //         by '\n' or by the end of the string; the last '\n' doesn't start a new line.
+    constexpr std::size_t numLines() const noexcept
+    {
+      return num_lines_;
+    }
+
+    // Decompresses the whole string into std::string.
+    constexpr std::string decompress() const
+    {
+      std::string result(kDecompressedSize, '\0');
+      decompressInto(result);
+      return result;
+    }
+
+    // Decompresses the whole string and appends it to the given std::string.
+    constexpr void decompress(std::string& dest) const
+    {
+      const std::size_t offset = dest.size();
+      dest.resize(offset + kDecompressedSize);
+      decompressInto(std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the whole string into the given buffer.
+    // \param dest - output buffer. Must have at least kDecompressedSize elements.
+    // \return the number of characters written, i.e. kDecompressedSize.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t decompressInto(std::span<char> dest) const
+    {
+      if (dest.size() < kDecompressedSize)
+      {
+        CTCS_THROW(std::length_error("BlockCompressedString::decompressInto(): the buffer is too small."));
+      }
+      for (std::size_t block = 0; block < kNumBlocks; ++block)
+      {
+        decompressBlock(block, dest.subspan(block * BlockSize));
+      }
+      return kDecompressedSize;
+    }
+
+    // Decompresses the given block into the given buffer.
+    // \param block - index of the block.
+    // \param dest - output buffer. Must have at least blockSize(block) elements.
+    // \return the number of characters written, i.e. blockSize(block).
+    // \throw std::out_of_range if block >= kNumBlocks.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t decompressBlock(std::size_t block, std::span<char> dest) const
+    {
+      const std::size_t block_size = blockSize(block);
+      if (dest.size() < block_size)
+      {
+        CTCS_THROW(std::length_error("BlockCompressedString::decompressBlock(): the buffer is too small."));
+      }
+      decodeBlock(block, 0, dest.first(block_size));
+      return block_size;
+    }
+
+    // \return the number of characters in the given block.
+    // \throw std::out_of_range if block >= kNumBlocks.
+    constexpr std::size_t blockSize(std::size_t block) const
+    {
+      if (block >= kNumBlocks)
+      {
+        CTCS_THROW(std::out_of_range("BlockCompressedString: block index is out of range."));
+      }
+      return std::min(BlockSize, kDecompressedSize - block * BlockSize);
+    }
+
+    // Returns the character at the given position. Only decodes the block containing it.
+    // \throw std::out_of_range if pos >= size().
+    constexpr char at(std::size_t pos) const
+    {
+      if (pos >= kDecompressedSize)
+      {
+        CTCS_THROW(std::out_of_range("BlockCompressedString::at(): pos is out of range."));
+      }
+      char result = 0;
+      decodeBlock(pos / BlockSize, pos % BlockSize, std::span<char>(&result, 1));
+      return result;
+    }
+
+    // Returns the substring [pos; pos + count), like std::string::substr().
+    // Only decodes the blocks that overlap with the substring.
+    // \throw std::out_of_range if pos > size().
+    constexpr std::string substr(std::size_t pos, std::size_t count = npos) const
+    {
+      if (pos > kDecompressedSize)
+      {
+        CTCS_THROW(std::out_of_range("BlockCompressedString::substr(): pos is out of range."));
+      }
+      count = std::min(count, kDecompressedSize - pos);
+      std::string result(count, '\0');
+      std::size_t num_decoded = 0;
+      while (num_decoded < count)
+      {
+        const std::size_t position = pos + num_decoded;
+        const std::size_t offset_in_block = position % BlockSize;
+        const std::size_t num_chars = std::min(BlockSize - offset_in_block, count - num_decoded);
+        decodeBlock(position / BlockSize, offset_in_block, std::span<char>(result).subspan(num_decoded, num_chars));
+        num_decoded += num_chars;
+      }
+      return result;
+    }
+
+    // Returns the line with the given index, without the terminating '\n'.
+    // Only decodes the blocks that contain the line and the preceding '\n'.
+    // \throw std::out_of_range if index >= numLines().
+    constexpr std::string line(std::size_t index) const
+    {
+      if (index >= num_lines_)
+      {
+        CTCS_THROW(std::out_of_range("BlockCompressedString::line(): index is out of range."));
+      }
+      const std::size_t total_newlines = newline_counts_.back();
+      const std::size_t first = (index == 0) ? 0 : findNewline(index) + 1;
+      const std::size_t last = (index < total_newlines) ? findNewline(index + 1) : kDecompressedSize;
+      return substr(first, last - first);
+    }
+
+    constexpr const StringLiteral<CompressedLength>& compressedData() const noexcept
+    {
+      return compressed_data_;
+    }
+
+  private:
+    // Decodes the characters [first; first + dest.size()) of the given block into dest.
+    constexpr void decodeBlock(std::size_t block, std::size_t first, std::span<char> dest) const
+    {
+      if (dest.empty())
+      {
+        return;
+      }
+      Detail_NS::ArithmeticCodingSymbolDecoder<Model> decoder(
+        compressed_data_.view().substr(block_offsets_[block]));
+      for (std::size_t i = 0; i < first; ++i)
+      {
+        decoder.decode();
+      }
+      for (char& c : dest)
+      {
+        c = decoder.decode();
+      }
+    }
+
+    // Finds the position of the n-th '\n' character, where 1 <= n <= the total number of '\n' characters.
+    constexpr std::size_t findNewline(std::size_t n) const
+    {
+      // The first block that contains the n-th newline.
+      const std::size_t block = static_cast<std::size_t>(
+        std::lower_bound(newline_counts_.begin() + 1, newline_counts_.end(), n) - (newline_counts_.begin() + 1));
+      std::size_t num_remaining = n - newline_counts_[block];
+      Detail_NS::ArithmeticCodingSymbolDecoder<Model> decoder(
+        compressed_data_.view().substr(block_offsets_[block]));
+      const std::size_t block_size = blockSize(block);
+      for (std::size_t i = 0; i < block_size; ++i)
+      {
+        if (decoder.decode() == '\n' && --num_remaining == 0)
+        {
+          return block * BlockSize + i;
+        }
+      }
+      CTCS_THROW(std::logic_error("BlockCompressedString: the checkpoint table is corrupted."));
+    }
+
+    StringLiteral<CompressedLength> compressed_data_;
+    // The offset of each block in compressed_data_, in bytes.
+    std::array<OffsetType, kNumBlocks> block_offsets_;
+    // newline_counts_[i] is the number of '\n' characters in the blocks [0; i).
+    std::array<LineCountType, kNumBlocks + 1> newline_counts_;
+    // The number of lines in the string.
+    LineCountType num_lines_;
+  };
+
+  namespace Detail_NS
+  {
+    // Encodes the given string in independently coded blocks.
+    // \param block_offsets - output parameter; receives the offset of each block, in bytes.
+    // \return the encoded blocks.
+    template<class Model, std::size_t BlockSize, std::size_t NumBlocks>
+    constexpr std::string encodeBlocks(std::string_view data, std::array<std::size_t, NumBlocks>& block_offsets)
+    {
+      std::string compressed_data;
+      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data);
+      for (std::size_t block = 0; block < NumBlocks; ++block)
+      {
+        block_offsets[block] = bit_stream.numBits() / 8;
+        encodeEntry<Model>(bit_stream, data.substr(block * BlockSize, BlockSize));
+        // Pad the block to a byte boundary.
+        bit_stream.finalize();
+      }
+      return compressed_data;
+    }
+
+    // Encoder for CompileTimeOutput, which encodes the given string literal via encodeBlocks().
+    template<StringLiteral Str, class Model, std::size_t BlockSize, std::size_t NumBlocks>
+    struct BlockEncoder
+    {
+      template<std::size_t Capacity>
+      struct Output
+      {
+        CompileTimeBuffer<Capacity> data;
+        // The offset of each block, in bytes.
+        std::array<std::size_t, NumBlocks> block_offsets;
+      };
+
+      template<std::size_t Capacity>
+      static consteval Output<Capacity> run()
+      {
+        Output<Capacity> output{};
+        output.data = CompileTimeBuffer<Capacity>(encodeBlocks<Model, BlockSize>(Str.view(), output.block_offsets));
+        return output;
+      }
+    };
+  }
+
+  // Compresses the given string literal in independently coded blocks.
+  // \param Str - input string.
+  // \param Model - ArithmeticCodingModel to use.
+  // \param BlockSize - the number of characters in a block. Smaller blocks make random access
+  //        cheaper, but increase the size of the checkpoint table and degrade the compression ratio.
+  template<StringLiteral Str, ArithmeticCoding_NS::ArithmeticCodingModel Model = EnglishCharModel,
+           std::size_t BlockSize = 1024>
+  consteval auto compressBlocks()
+  {
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+    static_assert(BlockSize > 0, "BlockSize must be positive.");
+
+    constexpr std::size_t kNumBlocks = (Str.size() + BlockSize - 1) / BlockSize;
+    // Normally, the blocks are only encoded once.
+    constexpr const auto& kEncodedBlocks = Detail_NS::CompileTimeOutput<
+      Detail_NS::BlockEncoder<Str, Model, BlockSize, kNumBlocks>, Detail_NS::guessCompressedCapacity(Str.size())>::kValue;
+    constexpr std::size_t kCompressedDataSize = kEncodedBlocks.data.size;
+    constexpr std::size_t kNumNewlines = static_cast<std::size_t>(std::count(Str.view().begin(), Str.view().end(), '\n'));
+    using OffsetType = Detail_NS::SmallestUnsigned<kCompressedDataSize>;
+    using LineCountType = Detail_NS::SmallestUnsigned<kNumNewlines + 1>;
+
+    StringLiteral<kCompressedDataSize> compressed_data_literal;
+    for (std::size_t i = 0; i < kCompressedDataSize; ++i)
+    {
+      compressed_data_literal.data[i] = kEncodedBlocks.data.data[i];
+    }
+    std::array<OffsetType, kNumBlocks> offsets{};
+    std::array<LineCountType, kNumBlocks + 1> newline_counts{};
+    for (std::size_t block = 0; block < kNumBlocks; ++block)
+    {
+      offsets[block] = static_cast<OffsetType>(kEncodedBlocks.block_offsets[block]);
+      const std::string_view block_data = Str.view().substr(block * BlockSize, BlockSize);
+      newline_counts[block + 1] = static_cast<LineCountType>(
+        newline_counts[block] + std::count(block_data.begin(), block_data.end(), '\n'));
+    }
+    const bool has_unterminated_line = !Str.view().empty() && Str.view().back() != '\n';
+    const LineCountType num_lines = static_cast<LineCountType>(kNumNewlines + (has_unterminated_line ? 1 : 0));
+    return BlockCompressedString<Model, BlockSize, kCompressedDataSize, Str.size(), OffsetType, LineCountType>(
+      compressed_data_literal, offsets, newline_counts, num_lines);
+  }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "StringLiteral.h"
+#include "internal/Exceptions.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace ctcs
+{
+  // Element type of binary data that can be compressed via ctcs::compress(): std::byte or unsigned char.
+  template<class T>
+  concept ByteType = std::is_same_v<T, std::byte> || std::is_same_v<T, unsigned char>;
+
+  namespace Detail_NS
+  {
+    template<class T>
+    struct IsByteArray : std::false_type {};
+
+    template<ByteType T, std::size_t N>
+    struct IsByteArray<std::array<T, N>> : std::true_type {};
+  }
+
+  // std::array of std::byte or unsigned char.
+  template<class T>
+  concept ByteArray = Detail_NS::IsByteArray<std::remove_cv_t<T>>::value;
+
+  // Compressed binary data; the counterpart of CompressedString for std::byte/unsigned char arrays.
+  // \param Decompressor - class that should be used to decompress the data.
+  // \param CompressedLength - size of the compressed data in bytes.
+  // \param DecompressedLength - size of the decompressed data in bytes.
+  // \param ByteT - element type of the decompressed data: std::byte or unsigned char.
+  template<class Decompressor, std::size_t CompressedLength, std::size_t DecompressedLength, ByteType ByteT>
+  class CompressedBytes
+  {
+  public:
+    using value_type = ByteT;
+    // The size of the decompressed data.
+    static constexpr std::size_t kDecompressedSize = DecompressedLength;
+    // The size of the compressed data.
+    static constexpr std::size_t kCompressedSize = CompressedLength;
+    // The size of the decompressed data divided by the size of the compressed data.
+    static constexpr double kCompressionRatio =
+      static_cast<double>(DecompressedLength) / static_cast<double>(CompressedLength == 0 ? 1 : CompressedLength);
+
+    explicit constexpr CompressedBytes(StringLiteral<CompressedLength> compressed_data) noexcept:
+      compressed_data_(compressed_data)
+    {
+    }
+
+    // Decompresses the data into std::vector.
+    constexpr std::vector<ByteT> decompress() const
+    {
+      std::vector<ByteT> result(kDecompressedSize);
+      decompressInto(result);
+      return result;
+    }
+
+    // Decompresses the data and appends it to the given std::vector.
+    constexpr void decompress(std::vector<ByteT>& dest) const
+    {
+      const std::size_t offset = dest.size();
+      dest.resize(offset + kDecompressedSize);
+      decompressInto(std::span<ByteT>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer without allocating any memory
+    // (except during constant evaluation).
+    // \param dest - output buffer. Must have at least kDecompressedSize elements.
+    // \return the number of bytes written, i.e. kDecompressedSize.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t decompressInto(std::span<ByteT> dest) const
+    {
+      if (dest.size() < kDecompressedSize)
+      {
+        CTCS_THROW(std::length_error("CompressedBytes::decompressInto(): the buffer is too small."));
+      }
+      if (std::is_constant_evaluated())
+      {
+        // The buffer cannot be reinterpreted as char during constant evaluation.
+        std::string buffer(kDecompressedSize, '\0');
+        const std::size_t size = Decompressor{}(compressed_data_.view(), std::span<char>(buffer));
+        std::transform(buffer.begin(), buffer.begin() + size, dest.begin(),
+                       [](char c) { return static_cast<ByteT>(static_cast<unsigned char>(c)); });
+        return size;
+      }
+      return Decompressor{}(compressed_data_.view(),
+                            std::span<char>(reinterpret_cast<char*>(dest.data()), kDecompressedSize));
+    }
+
+    // Decompresses the data into std::array without allocating any memory.
+    constexpr std::array<ByteT, kDecompressedSize> decompressToArray() const
+    {
+      std::array<ByteT, kDecompressedSize> result{};
+      decompressInto(result);
+      return result;
+    }
+
+    constexpr const StringLiteral<CompressedLength>& compressedData() const noexcept
+    {
+      return compressed_data_;
+    }
+
+  private:
+    StringLiteral<CompressedLength> compressed_data_;
+  };
+}
@@ -1,42 +1,144 @@
 #pragma once
 
+#include "DecodeObserver.h"
+#include "DecodePolicy.h"
 #include "StringLiteral.h"
+#include "internal/Exceptions.h"
 
+#include <array>
+#include <chrono>
 #include <cstddef>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 // ctcs = Compile-time Compressed String.
 namespace ctcs
 {
+  namespace Detail_NS
+  {
+    // The character type of the strings produced by the given decompressor:
+    // Decompressor::char_type if it is defined, char otherwise.
+    template<class Decompressor>
+    struct DecompressorCharType
+    {
+      using type = char;
+    };
+
+    template<class Decompressor> requires requires { typename Decompressor::char_type; }
+    struct DecompressorCharType<Decompressor>
+    {
+      using type = typename Decompressor::char_type;
+    };
+
+    // Decompressor that supports TrustedDecode.
+    template<class Decompressor, class CharT>
+    concept TrustedDecompressor = requires(Decompressor decompressor, std::string_view compressed_data,
+                                           std::span<CharT> dest)
+    {
+      decompressor(compressed_data, dest, TrustedDecode{});
+    };
+  }
+
   // Wrapper for StringLiteral.
+  //
+  // The compressed data is trusted to be valid: ctcs::compress() verifies at compile time that it
+  // decompresses into the original string. Thus, if Decompressor supports TrustedDecode, the data
+  // is decompressed without any checks. Use Decompressor directly for untrusted data.
   // \param Decompressor - class that should be used to decompress the data.
   // \param CompressedLength - size of the compressed data in bytes.
-  template<class Decompressor, std::size_t CompressedLength>
+  // \param DecompressedLength - size of the decompressed data in characters.
+  // \param Observer - DecodeObserver, which is notified about every runtime decompression.
+  //        The default one (NoDecodeObserver) adds no overhead.
+  template<class Decompressor, std::size_t CompressedLength, std::size_t DecompressedLength,
+           DecodeObserver Observer = NoDecodeObserver>
   class CompressedString
   {
   public:
+    // The character type of the decompressed string.
+    using char_type = typename Detail_NS::DecompressorCharType<Decompressor>::type;
+    // The size of the decompressed string.
+    static constexpr std::size_t kDecompressedSize = DecompressedLength;
+    // The size of the compressed data.
+    static constexpr std::size_t kCompressedSize = CompressedLength;
+    // The size of the decompressed string divided by the size of the compressed data.
+    static constexpr double kCompressionRatio =
+      static_cast<double>(DecompressedLength) / static_cast<double>(CompressedLength == 0 ? 1 : CompressedLength);
+    // The average number of bits of compressed data per character of the decompressed string.
+    // 0 for an empty string.
+    static constexpr double kBitsPerChar = (DecompressedLength == 0) ? 0.0 :
+      static_cast<double>(CompressedLength * 8) / static_cast<double>(DecompressedLength);
+
+    // \param compressed_data - the data produced by the compressor for Decompressor, which
+    //        decompresses into DecompressedLength characters.
     explicit constexpr CompressedString(StringLiteral<CompressedLength> compressed_data) noexcept:
       compressed_data_(compressed_data)
     {
     }
 
-    // Decompresses the data into std::string.
-    constexpr std::string decompress() const
+    // Decompresses the data into std::basic_string.
+    constexpr std::basic_string<char_type> decompress() const
+    {
+      std::basic_string<char_type> result(kDecompressedSize, char_type{});
+      decompressInto(result);
+      return result;
+    }
+
+    // Decompresses the data and appends it to the given std::basic_string.
+    constexpr void decompress(std::basic_string<char_type>& dest) const
+    {
+      const std::size_t offset = dest.size();
+      dest.resize(offset + kDecompressedSize);
+      decompressInto(std::span<char_type>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer without allocating any memory.
+    // The other decompression functions call this one, so it is the only one that notifies the Observer.
+    // \param dest - output buffer. Must have at least kDecompressedSize elements.
+    // \return the number of characters written, i.e. kDecompressedSize.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t decompressInto(std::span<char_type> dest) const
+    {
+      if (dest.size() < kDecompressedSize)
+      {
+        CTCS_THROW(std::length_error("CompressedString::decompressInto(): the buffer is too small."));
+      }
+      if constexpr (!std::is_same_v<Observer, NoDecodeObserver>)
+      {
+        if (!std::is_constant_evaluated())
+        {
+          const auto start = std::chrono::steady_clock::now();
+          const std::size_t num_chars = decode(dest.first(kDecompressedSize));
+          const auto elapsed = std::chrono::steady_clock::now() - start;
+          Observer::onDecode(DecodeEvent{ compressed_data_.view(), asChars(dest.first(num_chars)),
+                                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) });
+          return num_chars;
+        }
+      }
+      return decode(dest.first(kDecompressedSize));
+    }
+
+    // Decompresses the data into std::array without allocating any memory.
+    constexpr std::array<char_type, kDecompressedSize> decompressToArray() const
     {
-      std::string result;
-      decompress(result);
+      std::array<char_type, kDecompressedSize> result{};
+      decompressInto(result);
       return result;
     }
 
-    // Decompresses the data and appends it to the given std::string.
-    constexpr void decompress(std::string& dest) const
+    // Returns an incremental decompressor, which decodes the data a few characters at a time.
+    // This object must outlive the returned stream.
+    // Only available if Decompressor defines the type Stream.
+    constexpr auto stream() const requires requires { typename Decompressor::Stream; }
     {
-      Decompressor{}(compressed_data_.view(), dest);
+      return typename Decompressor::Stream(compressed_data_.view());
     }
 
-    // Implicit conversion to std::string.
+    // Implicit conversion to std::basic_string.
     // \return the decompressed string.
-    constexpr operator std::string() const
+    constexpr operator std::basic_string<char_type>() const
     {
       return decompress();
     }
@@ -47,10 +149,37 @@ namespace ctcs
     }
 
   private:
+    // Decompresses the data into the given buffer of kDecompressedSize characters.
+    constexpr std::size_t decode(std::span<char_type> dest) const
+    {
+      if constexpr (Detail_NS::TrustedDecompressor<Decompressor, char_type>)
+      {
+        return Decompressor{}(compressed_data_.view(), dest, TrustedDecode{});
+      }
+      else
+      {
+        return Decompressor{}(compressed_data_.view(), dest);
+      }
+    }
+
+    // \return the object representation of the given characters.
+    static std::span<const char> asChars(std::span<const char_type> str) noexcept
+    {
+      if constexpr (std::is_same_v<char_type, char>)
+      {
+        return str;
+      }
+      else
+      {
+        const std::span<const std::byte> bytes = std::as_bytes(str);
+        return std::span<const char>(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+      }
+    }
+
     StringLiteral<CompressedLength> compressed_data_;
   };
 
   // Deduction guides for CompressedString.
-  template <class Decompressor, std::size_t N> CompressedString(CompressedString<Decompressor, N>)
-    -> CompressedString<Decompressor, N>;
+  template <class Decompressor, std::size_t N, std::size_t M, class Observer>
+  CompressedString(CompressedString<Decompressor, N, M, Observer>) -> CompressedString<Decompressor, N, M, Observer>;
 }
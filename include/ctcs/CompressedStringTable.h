@@ -0,0 +1,266 @@
+#pragma once
+
+#include "DecodePolicy.h"
+#include "EnglishCharModel.h"
+#include "StringLiteral.h"
+#include "internal/ArithmeticCoder.h"
+#include "internal/ArithmeticDecoder.h"
+#include "internal/CompileTimeBuffer.h"
+#include "internal/Exceptions.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // The smallest unsigned integer type that can represent the given value.
+    template<std::uint64_t MaxValue>
+    using SmallestUnsigned =
+      std::conditional_t<MaxValue <= std::numeric_limits<std::uint8_t>::max(), std::uint8_t,
+      std::conditional_t<MaxValue <= std::numeric_limits<std::uint16_t>::max(), std::uint16_t,
+      std::conditional_t<MaxValue <= std::numeric_limits<std::uint32_t>::max(), std::uint32_t, std::uint64_t>>>;
+
+    // Encodes the given string via arithmetic coding, starting at the current position of the bit stream.
+    //
+    // Doesn't write the size of the string, and doesn't pad the output to a byte boundary, so that
+    // several strings can be packed into a single stream. The code written by ArithmeticCoder::finalize()
+    // remains valid regardless of the bits that follow it, so each string can be decoded independently.
+    // Nothing is written for an empty string.
+    template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+    constexpr void encodeEntry(ArithmeticCoding_NS::OBitStream& bit_stream, std::string_view data)
+    {
+      if (data.empty())
+      {
+        return;
+      }
+      ArithmeticCoding_NS::ArithmeticCoder coder(bit_stream);
+      Model model {};
+      for (char c : data)
+      {
+        coder.encode(model, c);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model.update(c);
+        }
+      }
+      coder.finalize();
+    }
+
+    // Decodes a string encoded via encodeEntry() and appends it to `dest`.
+    // \param compressed_data - the stream containing the encoded string.
+    // \param bit_offset - the position of the encoded string in the stream, in bits.
+    // \param decompressed_size - the size of the string.
+    // \param dest - output string.
+    template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+    constexpr void decodeEntry(std::string_view compressed_data, std::size_t bit_offset,
+                               std::size_t decompressed_size, std::string& dest)
+    {
+      if (decompressed_size == 0)
+      {
+        return;
+      }
+      const std::size_t byte_offset = bit_offset / 8;
+      if (byte_offset >= compressed_data.size())
+      {
+        CTCS_THROW(std::out_of_range("decodeEntry(): bit_offset is out of range."));
+      }
+      ArithmeticCoding_NS::IBitStream bit_stream(compressed_data.data() + byte_offset,
+                                                 compressed_data.size() - byte_offset);
+      bit_stream.get(static_cast<unsigned int>(bit_offset % 8));
+      ArithmeticCoding_NS::BasicArithmeticDecoder<CheckedDecode> decoder(bit_stream);
+      Model model {};
+      const std::size_t offset = dest.size();
+      dest.resize(offset + decompressed_size);
+      for (std::size_t i = offset; i < dest.size(); ++i)
+      {
+        const char c = decoder.decode(model);
+        dest[i] = c;
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model.update(c);
+        }
+      }
+    }
+  }
+
+  // A table of strings compressed at compile time into a single contiguous blob.
+  //
+  // All strings are encoded with the same model and packed at bit granularity without any
+  // per-string headers or padding. The index stores a single integer per string: the position
+  // of the encoded string in the blob (in bits) and the size of the decompressed string, packed
+  // into the smallest unsigned type that can hold both. Each string can be decompressed independently.
+  // Use ctcs::compressTable() to construct objects of this class.
+  // \param Model - ArithmeticCodingModel used to encode the strings. If the model is adaptive,
+  //        every string is encoded with a fresh instance of the model.
+  // \param NumStrings - the number of strings in the table.
+  // \param CompressedLength - size of the compressed data in bytes.
+  // \param SizeBits - the number of lower bits of an index entry that store the size of the decompressed string.
+  // \param IndexEntry - unsigned integer type of an index entry.
+  template<class Model, std::size_t NumStrings, std::size_t CompressedLength, unsigned int SizeBits, class IndexEntry>
+  class CompressedStringTable
+  {
+  public:
+    constexpr CompressedStringTable(StringLiteral<CompressedLength> compressed_data,
+                                    std::array<IndexEntry, NumStrings> index) noexcept:
+      compressed_data_(compressed_data),
+      index_(index)
+    {
+    }
+
+    // \return the number of strings in the table.
+    constexpr std::size_t size() const noexcept
+    {
+      return NumStrings;
+    }
+
+    // \return the size of the decompressed string with the given index.
+    // \throw std::out_of_range if index >= size().
+    constexpr std::size_t decompressedSize(std::size_t index) const
+    {
+      checkIndex(index);
+      return static_cast<std::size_t>(index_[index] & kSizeMask);
+    }
+
+    // Decompresses the string with the given index into std::string.
+    // \throw std::out_of_range if index >= size().
+    constexpr std::string get(std::size_t index) const
+    {
+      std::string result;
+      decompress(index, result);
+      return result;
+    }
+
+    // Decompresses the string with the given index and appends it to the given std::string.
+    // Only the requested string is decoded.
+    // \throw std::out_of_range if index >= size().
+    constexpr void decompress(std::size_t index, std::string& dest) const
+    {
+      checkIndex(index);
+      const std::size_t bit_offset = static_cast<std::size_t>(index_[index] >> SizeBits);
+      const std::size_t decompressed_size = static_cast<std::size_t>(index_[index] & kSizeMask);
+      Detail_NS::decodeEntry<Model>(compressed_data_.view(), bit_offset, decompressed_size, dest);
+    }
+
+    constexpr const StringLiteral<CompressedLength>& compressedData() const noexcept
+    {
+      return compressed_data_;
+    }
+
+  private:
+    static constexpr IndexEntry kSizeMask = static_cast<IndexEntry>((std::uint64_t{ 1 } << SizeBits) - 1);
+
+    static constexpr void checkIndex(std::size_t index)
+    {
+      if (index >= NumStrings)
+      {
+        CTCS_THROW(std::out_of_range("CompressedStringTable: index is out of range."));
+      }
+    }
+
+    StringLiteral<CompressedLength> compressed_data_;
+    // (bit offset << SizeBits) | decompressed size for each string.
+    std::array<IndexEntry, NumStrings> index_;
+  };
+
+  namespace Detail_NS
+  {
+    // Encodes the given strings into a single blob.
+    // \param bit_offsets - output parameter; receives the position of each string in the blob, in bits.
+    // \return the blob.
+    template<class Model, StringLiteral... Strs>
+    constexpr std::string encodeTable(std::array<std::size_t, sizeof...(Strs)>& bit_offsets)
+    {
+      const std::array<std::string_view, sizeof...(Strs)> strings = { Strs.view()... };
+      std::string compressed_data;
+      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data);
+      for (std::size_t i = 0; i < strings.size(); ++i)
+      {
+        bit_offsets[i] = bit_stream.numBits();
+        encodeEntry<Model>(bit_stream, strings[i]);
+      }
+      bit_stream.finalize();
+      return compressed_data;
+    }
+
+    // Encoder for CompileTimeOutput, which encodes the given string literals via encodeTable().
+    template<class Model, StringLiteral... Strs>
+    struct TableEncoder
+    {
+      template<std::size_t Capacity>
+      struct Output
+      {
+        CompileTimeBuffer<Capacity> data;
+        // The position of each string in the blob, in bits.
+        std::array<std::size_t, sizeof...(Strs)> bit_offsets;
+      };
+
+      template<std::size_t Capacity>
+      static consteval Output<Capacity> run()
+      {
+        Output<Capacity> output{};
+        output.data = CompileTimeBuffer<Capacity>(encodeTable<Model, Strs...>(output.bit_offsets));
+        return output;
+      }
+    };
+
+    template<class Model, StringLiteral... Strs>
+    consteval auto compressTableImpl()
+    {
+      constexpr std::size_t kNumStrings = sizeof...(Strs);
+      // Normally, the strings are only encoded once.
+      constexpr const auto& kEncodedTable = CompileTimeOutput<TableEncoder<Model, Strs...>,
+        guessCompressedCapacity((std::size_t{ 0 } + ... + Strs.size()))>::kValue;
+      constexpr std::size_t kCompressedDataSize = kEncodedTable.data.size;
+      constexpr std::size_t kMaxSize = std::max<std::size_t>({ std::size_t{ 0 }, Strs.size()... });
+      constexpr unsigned int kSizeBits = static_cast<unsigned int>(std::bit_width(kMaxSize));
+      constexpr unsigned int kOffsetBits = static_cast<unsigned int>(std::bit_width(kCompressedDataSize * 8));
+      static_assert(kSizeBits + kOffsetBits <= 64, "The table is too large.");
+      using IndexEntry = SmallestUnsigned<(kSizeBits + kOffsetBits == 64) ?
+        std::numeric_limits<std::uint64_t>::max() : (std::uint64_t{ 1 } << (kSizeBits + kOffsetBits)) - 1>;
+
+      StringLiteral<kCompressedDataSize> compressed_data_literal;
+      for (std::size_t i = 0; i < kCompressedDataSize; ++i)
+      {
+        compressed_data_literal.data[i] = kEncodedTable.data.data[i];
+      }
+      const std::array<std::size_t, kNumStrings> sizes = { Strs.size()... };
+      std::array<IndexEntry, kNumStrings> index{};
+      for (std::size_t i = 0; i < kNumStrings; ++i)
+      {
+        index[i] = static_cast<IndexEntry>(
+          (static_cast<std::uint64_t>(kEncodedTable.bit_offsets[i]) << kSizeBits) | sizes[i]);
+      }
+      return CompressedStringTable<Model, kNumStrings, kCompressedDataSize, kSizeBits, IndexEntry>(
+        compressed_data_literal, index);
+    }
+  }
+
+  // Compresses the given string literals into a single table.
+  // \param Strs - input strings.
+  template<StringLiteral... Strs>
+  consteval auto compressTable()
+  {
+    return Detail_NS::compressTableImpl<EnglishCharModel, Strs...>();
+  }
+
+  // Compresses the given string literals into a single table.
+  // \param Model - ArithmeticCodingModel to use.
+  // \param Strs - input strings.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model, StringLiteral... Strs>
+  consteval auto compressTable()
+  {
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+    return Detail_NS::compressTableImpl<Model, Strs...>();
+  }
+}
@@ -0,0 +1,280 @@
+#pragma once
+
+#include "AdaptiveModel.h"
+#include "DecodePolicy.h"
+#include "internal/ArithmeticCoding.h"
+#include "internal/Exceptions.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+namespace ctcs
+{
+  // Adaptive ArithmeticCodingModel for encoding char elements, which conditions on the
+  // previous Order characters.
+  //
+  // Every context (i.e. the previous Order characters) is hashed into one of 2^LogNumContexts
+  // slots. A slot stores up to kContextCapacity symbols that have been seen in this context
+  // together with their counts. A symbol that hasn't been seen in the current context is encoded
+  // via an "escape" into an adaptive order-0 model (like in PPM). Thus, the memory used by the model
+  // doesn't depend on the size of the alphabet, and the cost of any operation is bounded by
+  // O(kContextCapacity + log 256).
+  //
+  // The model doesn't need any precomputed tables: it's built from scratch by both the compressor
+  // and the decompressor.
+  // \param Order - the number of previous characters to condition on; 1 or 2.
+  // \param LogNumContexts - binary logarithm of the number of context slots.
+  template<unsigned int Order, unsigned int LogNumContexts = (Order == 1 ? 8 : 10)>
+  class ContextModel
+  {
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+    using char_type = char;
+
+    static_assert(Order == 1 || Order == 2, "Only order-1 and order-2 contexts are supported.");
+    static_assert(LogNumContexts > 0 && LogNumContexts <= 16, "LogNumContexts must be within [1; 16].");
+
+    // The maximum number of distinct symbols stored for each context.
+    static constexpr std::size_t kContextCapacity = 16;
+
+    constexpr FrequencyCount scalingFactor() const noexcept
+    {
+      const Context& context = currentContext();
+      return (context.total + escapeCount(context)) * order0_.scalingFactor();
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    constexpr char_type getCharByPoint(FrequencyCount value) const
+    {
+      return decodeSymbol(value).symbol;
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    // \return the character and its interval.
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value) const
+    {
+      return decodeSymbol(value, CheckedDecode{});
+    }
+
+    // Same as above, but with TrustedDecode the value is trusted to be less than scalingFactor(),
+    // and isn't checked.
+    template<DecodePolicy Policy>
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value, Policy) const;
+
+    // Returns the interval for the specified character.
+    constexpr std::pair<FrequencyCount, FrequencyCount> getInterval(char_type character) const;
+
+    // Updates the model after encoding/decoding the specified character.
+    constexpr void update(char_type character);
+
+    // Restores the state of a default-constructed model. Only the contexts that have been updated
+    // are cleared, so this is much cheaper than assigning a new model after a short string.
+    constexpr void reset() noexcept;
+
+  private:
+    // Symbols seen in a context.
+    struct Context
+    {
+      // The symbols, sorted by their counts in non-increasing order.
+      std::array<unsigned char, kContextCapacity> symbols{};
+      std::array<std::uint16_t, kContextCapacity> counts{};
+      // The sum of counts.
+      std::uint16_t total = 0;
+      // The number of symbols.
+      std::uint8_t size = 0;
+    };
+
+    static constexpr std::size_t kNumContexts = std::size_t{ 1 } << LogNumContexts;
+    // The number of 64-bit words in used_contexts_.
+    static constexpr std::size_t kNumUsedContextWords = (kNumContexts + 63) / 64;
+    // The counts in a context are halved when their total reaches this value.
+    // The scaling factor of the order-0 model never exceeds 2^16, so this ensures that
+    // scalingFactor() doesn't exceed kMaxFrequency.
+    static constexpr std::uint16_t kMaxContextTotal = 1 << 13;
+
+    static_assert(static_cast<std::uint64_t>(kMaxContextTotal + kContextCapacity) * (1 << 16) <=
+                  ArithmeticCoding_NS::ArithmeticCodingTraits::kMaxFrequency,
+                  "The scaling factor of ContextModel must not exceed kMaxFrequency.");
+
+    // The weight of the escape symbol in the given context.
+    static constexpr FrequencyCount escapeCount(const Context& context) noexcept
+    {
+      return context.size == 0 ? 1 : context.size;
+    }
+
+    constexpr const Context& currentContext() const noexcept
+    {
+      return contexts_[context_index_];
+    }
+
+    // Computes the slot for the current history_.
+    constexpr std::size_t computeContextIndex() const noexcept;
+
+    // Halves the counts in the given context.
+    static constexpr void rescale(Context& context) noexcept;
+
+    // Symbols seen in each context.
+    std::array<Context, kNumContexts> contexts_{};
+    // The model for the symbols that haven't been seen in the current context.
+    AdaptiveCharModel order0_{};
+    // The previous Order characters; the last one is in the least significant byte.
+    std::uint32_t history_ = 0;
+    // Index of the slot for history_.
+    std::size_t context_index_ = 0;
+    // Bit i is set if contexts_[i] has been updated since the construction or the last reset().
+    std::array<std::uint64_t, kNumUsedContextWords> used_contexts_{};
+  };
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  template<DecodePolicy Policy>
+  constexpr ArithmeticCoding_NS::DecodedSymbol<char>
+  ContextModel<Order, LogNumContexts>::decodeSymbol(FrequencyCount value, Policy) const
+  {
+    const Context& context = currentContext();
+    const FrequencyCount order0_scaling_factor = order0_.scalingFactor();
+    const FrequencyCount escape_lower = context.total * order0_scaling_factor;
+    if (value < escape_lower)
+    {
+      const FrequencyCount point = value / order0_scaling_factor;
+      FrequencyCount lower = 0;
+      for (std::size_t i = 0; i < context.size; ++i)
+      {
+        const FrequencyCount upper = lower + context.counts[i];
+        if (point < upper)
+        {
+          return { static_cast<char_type>(context.symbols[i]),
+                   { lower * order0_scaling_factor, upper * order0_scaling_factor } };
+        }
+        lower = upper;
+      }
+    }
+    if constexpr (Policy::kChecked)
+    {
+      if (value >= scalingFactor())
+      {
+        CTCS_THROW(std::out_of_range("ContextModel::decodeSymbol(): value is out of range."));
+      }
+    }
+    // The symbol hasn't been seen in this context - use the order-0 model.
+    const FrequencyCount escape_count = escapeCount(context);
+    const ArithmeticCoding_NS::DecodedSymbol<char> decoded =
+      order0_.decodeSymbol((value - escape_lower) / escape_count, Policy{});
+    return { decoded.symbol, { escape_lower + decoded.interval.first * escape_count,
+                               escape_lower + decoded.interval.second * escape_count } };
+  }
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  constexpr std::pair<typename ContextModel<Order, LogNumContexts>::FrequencyCount,
+                      typename ContextModel<Order, LogNumContexts>::FrequencyCount>
+  ContextModel<Order, LogNumContexts>::getInterval(char_type character) const
+  {
+    const unsigned char symbol = static_cast<unsigned char>(character);
+    const Context& context = currentContext();
+    const FrequencyCount order0_scaling_factor = order0_.scalingFactor();
+    FrequencyCount lower = 0;
+    for (std::size_t i = 0; i < context.size; ++i)
+    {
+      if (context.symbols[i] == symbol)
+      {
+        return { lower * order0_scaling_factor, (lower + context.counts[i]) * order0_scaling_factor };
+      }
+      lower += context.counts[i];
+    }
+    // The symbol hasn't been seen in this context - use the order-0 model.
+    const FrequencyCount escape_lower = context.total * order0_scaling_factor;
+    const FrequencyCount escape_count = escapeCount(context);
+    const std::pair<FrequencyCount, FrequencyCount> interval = order0_.getInterval(character);
+    return { escape_lower + interval.first * escape_count, escape_lower + interval.second * escape_count };
+  }
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  constexpr void ContextModel<Order, LogNumContexts>::update(char_type character)
+  {
+    const unsigned char symbol = static_cast<unsigned char>(character);
+    Context& context = contexts_[context_index_];
+    used_contexts_[context_index_ / 64] |= std::uint64_t{ 1 } << (context_index_ % 64);
+    std::size_t i = 0;
+    while (i < context.size && context.symbols[i] != symbol)
+    {
+      ++i;
+    }
+    if (i == context.size)
+    {
+      if (context.size < kContextCapacity)
+      {
+        ++context.size;
+      }
+      else
+      {
+        // Evict the least frequent symbol.
+        i = kContextCapacity - 1;
+        context.total -= context.counts[i];
+      }
+      context.symbols[i] = symbol;
+      context.counts[i] = 0;
+    }
+    ++context.counts[i];
+    ++context.total;
+    // Keep the symbols sorted by their counts, so that the frequent ones are found faster.
+    for (; i > 0 && context.counts[i - 1] < context.counts[i]; --i)
+    {
+      std::swap(context.symbols[i - 1], context.symbols[i]);
+      std::swap(context.counts[i - 1], context.counts[i]);
+    }
+    if (context.total >= kMaxContextTotal)
+    {
+      rescale(context);
+    }
+    order0_.update(character);
+    // Shift the history.
+    constexpr std::uint32_t kHistoryMask = (std::uint32_t{ 1 } << (8 * Order)) - 1;
+    history_ = ((history_ << 8) | symbol) & kHistoryMask;
+    context_index_ = computeContextIndex();
+  }
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  constexpr void ContextModel<Order, LogNumContexts>::reset() noexcept
+  {
+    for (std::size_t word = 0; word < kNumUsedContextWords; ++word)
+    {
+      for (std::uint64_t bits = used_contexts_[word]; bits != 0; bits &= bits - 1)
+      {
+        contexts_[word * 64 + static_cast<std::size_t>(std::countr_zero(bits))] = Context{};
+      }
+      used_contexts_[word] = 0;
+    }
+    order0_ = AdaptiveCharModel{};
+    history_ = 0;
+    context_index_ = 0;
+  }
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  constexpr std::size_t ContextModel<Order, LogNumContexts>::computeContextIndex() const noexcept
+  {
+    if constexpr (8 * Order <= LogNumContexts)
+    {
+      return history_;
+    }
+    else
+    {
+      // Fibonacci hashing.
+      constexpr std::uint32_t kMultiplier = 2654435769u;
+      return static_cast<std::size_t>(static_cast<std::uint32_t>(history_ * kMultiplier) >> (32 - LogNumContexts));
+    }
+  }
+
+  template<unsigned int Order, unsigned int LogNumContexts>
+  constexpr void ContextModel<Order, LogNumContexts>::rescale(Context& context) noexcept
+  {
+    context.total = 0;
+    for (std::size_t i = 0; i < context.size; ++i)
+    {
+      context.counts[i] = static_cast<std::uint16_t>((context.counts[i] + 1) / 2);
+      context.total = static_cast<std::uint16_t>(context.total + context.counts[i]);
+    }
+  }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <string_view>
+
+namespace ctcs
+{
+  // Information about a single runtime decompression of a CompressedString, reported to its DecodeObserver.
+  struct DecodeEvent
+  {
+    // The compressed data. Identifies the string: the same literal compressed with the same compressor
+    // always yields the same data.
+    std::string_view compressed_data;
+    // The decompressed string produced by this call. For strings of characters other than char,
+    // the object representation of the string.
+    std::span<const char> decompressed_data;
+    // Time spent decompressing the string.
+    std::chrono::nanoseconds elapsed;
+  };
+
+  // The default observer for CompressedString, which disables instrumentation altogether:
+  // decompression doesn't even read the clock.
+  struct NoDecodeObserver
+  {
+  };
+
+  // Observer for CompressedString: a class with a static member function onDecode(const DecodeEvent&),
+  // which is called after every runtime decompression of the string.
+  //
+  // Decompression during constant evaluation, and decompression via stream() are not reported.
+  // onDecode() may be called concurrently from several threads.
+  template<class Observer>
+  concept DecodeObserver = std::same_as<Observer, NoDecodeObserver> ||
+    requires(const DecodeEvent& event) { Observer::onDecode(event); };
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <concepts>
+
+namespace ctcs
+{
+  // Decode policy for data that may be corrupted or malicious, e.g. received at runtime.
+  // Every read is bounds-checked, and invalid data is reported via exceptions.
+  // This is the default policy of all decompressors.
+  struct CheckedDecode
+  {
+    static constexpr bool kChecked = true;
+  };
+
+  // Decode policy for data that is known to be valid: the data compressed by ctcs::compress(),
+  // which verifies the round trip at compile time, or by the ctcs_pack tool, which verifies it
+  // before generating the header. Invalid data results in undefined behavior.
+  //
+  // Supported by:
+  // * ArithmeticCodingDecompressor, which skips the checks of the header and the end of the data,
+  //   and lets the model skip the validation of the decoded points. The size of the buffer is
+  //   still checked, since it is not a part of the data.
+  //   The built-in models (StaticCharModel, EnglishCharModel, TrainedCharModel, AdaptiveModel,
+  //   ContextModel, Utf8Model) support that, so decoding with them doesn't throw. Custom models can
+  //   provide `decodeSymbol(FrequencyCount, TrustedDecode)`; otherwise, the checked decodeSymbol()
+  //   or getCharByPoint() is called.
+  // * UnicodeDecompressor over ArithmeticCodingDecompressor (i.e. the default one for u8"", u"", U""
+  //   and L"" literals), which also skips the validation of the UTF-8 representation.
+  // The other decompressors (RangeCoding, InterleavedRangeCoding, Huffman, Lz, Binary) and
+  // CompressedStringTable, BlockCompressedString and CompressedBytes always validate the data.
+  //
+  // CompressedString uses this policy if its Decompressor supports it, i.e. if it can be called as
+  //   Decompressor{}(compressed_data, dest, TrustedDecode{})
+  struct TrustedDecode
+  {
+    static constexpr bool kChecked = false;
+  };
+
+  // CheckedDecode or TrustedDecode.
+  template<class T>
+  concept DecodePolicy = std::same_as<T, CheckedDecode> || std::same_as<T, TrustedDecode>;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "DecodeObserver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctcs
+{
+  // DecodeObserver, which aggregates the decompressions of every observed string.
+  //
+  // Helps to find the strings that are decompressed on hot paths, and should rather be cached
+  // (e.g., via ctcs::lazy()) or left uncompressed.
+  // Usage:
+  //   constexpr auto kStr = ctcs::compress<"...", ctcs::ArithmeticCodingCompressor<ctcs::EnglishCharModel>,
+  //                                        ctcs::DecodeProfiler>();
+  //   ...
+  //   for (const ctcs::DecodeProfiler::Entry& entry : ctcs::DecodeProfiler::entries()) { ... }
+  class DecodeProfiler
+  {
+  public:
+    // Statistics for a single string.
+    struct Entry
+    {
+      // The decompressed string (see DecodeEvent::decompressed_data).
+      std::string text;
+      // The size of the compressed data.
+      std::size_t compressed_size = 0;
+      // The number of times the string has been decompressed.
+      std::size_t num_decodes = 0;
+      // The total number of bytes produced by these decompressions.
+      std::size_t num_bytes = 0;
+      // The total time spent decompressing the string.
+      std::chrono::nanoseconds elapsed {};
+    };
+
+    // Records the given decompression.
+    static void onDecode(const DecodeEvent& event)
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      auto iter = entries_.find(event.compressed_data);
+      if (iter == entries_.end())
+      {
+        Entry entry;
+        entry.text.assign(event.decompressed_data.begin(), event.decompressed_data.end());
+        entry.compressed_size = event.compressed_data.size();
+        iter = entries_.emplace(std::string(event.compressed_data), std::move(entry)).first;
+      }
+      Entry& entry = iter->second;
+      ++entry.num_decodes;
+      entry.num_bytes += event.decompressed_data.size();
+      entry.elapsed += event.elapsed;
+    }
+
+    // \return statistics for every string that has been decompressed since the start of the program
+    //         (or the last call to reset()), sorted by the total time spent decompressing it, in descending order.
+    static std::vector<Entry> entries()
+    {
+      std::vector<Entry> result;
+      {
+        const std::lock_guard<std::mutex> lock(mutex_);
+        result.reserve(entries_.size());
+        for (const auto& [compressed_data, entry] : entries_)
+        {
+          result.push_back(entry);
+        }
+      }
+      std::sort(result.begin(), result.end(), [](const Entry& lhs, const Entry& rhs)
+      {
+        return lhs.elapsed > rhs.elapsed;
+      });
+      return result;
+    }
+
+    // Discards all statistics.
+    static void reset()
+    {
+      const std::lock_guard<std::mutex> lock(mutex_);
+      entries_.clear();
+    }
+
+  private:
+    static inline std::mutex mutex_;
+    // Statistics for each string, indexed by its compressed data.
+    static inline std::map<std::string, Entry, std::less<>> entries_;
+  };
+}
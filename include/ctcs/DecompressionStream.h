@@ -0,0 +1,176 @@
+#pragma once
+
+#include "DecodePolicy.h"
+#include "internal/VarInt.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+
+namespace ctcs
+{
+  // Incremental decompressor, which decodes the data a few characters at a time.
+  //
+  // Unlike Decompressor, this class doesn't need a buffer for the whole decompressed string:
+  // the data can be read in chunks of any size via read(), or character by character via the
+  // input range [begin(); end()). Decoding can be stopped at any point.
+  //
+  // The stream doesn't own the compressed data, so the data must outlive the stream.
+  // \param SymbolDecoder - class that decodes the compressed data (without the header) one
+  //        character at a time. It should be constructible from std::string_view, and should
+  //        have the member function `char decode()`.
+  // \param Policy - the DecodePolicy for reading the header.
+  template<class SymbolDecoder, DecodePolicy Policy = CheckedDecode>
+  class DecompressionStream
+  {
+  public:
+    // Input iterator over the decompressed characters.
+    class Iterator
+    {
+    public:
+      using value_type = char;
+      using difference_type = std::ptrdiff_t;
+
+      constexpr Iterator() noexcept = default;
+
+      constexpr char operator*() const noexcept
+      {
+        return current_;
+      }
+
+      constexpr Iterator& operator++()
+      {
+        advance();
+        return *this;
+      }
+
+      constexpr void operator++(int)
+      {
+        advance();
+      }
+
+      friend constexpr bool operator==(const Iterator& iter, std::default_sentinel_t) noexcept
+      {
+        return iter.stream_ == nullptr;
+      }
+
+    private:
+      friend class DecompressionStream;
+
+      explicit constexpr Iterator(DecompressionStream& stream):
+        stream_(&stream)
+      {
+        advance();
+      }
+
+      constexpr void advance()
+      {
+        if (stream_->done())
+        {
+          stream_ = nullptr;
+          return;
+        }
+        current_ = stream_->decodeNext();
+      }
+
+      // The stream, or nullptr if the end has been reached.
+      DecompressionStream* stream_ = nullptr;
+      // The last character read from the stream.
+      char current_ = 0;
+    };
+
+    // Constructs a stream over the given compressed data.
+    explicit constexpr DecompressionStream(std::string_view compressed_data);
+
+    // Non-copyable, non-movable: the decoder may refer to its own members.
+    DecompressionStream(const DecompressionStream&) = delete;
+    DecompressionStream(DecompressionStream&&) = delete;
+    DecompressionStream& operator=(const DecompressionStream&) = delete;
+    DecompressionStream& operator=(DecompressionStream&&) = delete;
+
+    constexpr ~DecompressionStream() = default;
+
+    // \return the size of the decompressed data.
+    constexpr std::size_t size() const noexcept
+    {
+      return size_;
+    }
+
+    // \return the number of characters that haven't been read yet.
+    constexpr std::size_t remaining() const noexcept
+    {
+      return size_ - position_;
+    }
+
+    // \return true if all characters have been read, false otherwise.
+    constexpr bool done() const noexcept
+    {
+      return position_ == size_;
+    }
+
+    // Decompresses the next characters into the given buffer.
+    // \param dest - output buffer.
+    // \return the number of characters written, i.e. min(dest.size(), remaining()).
+    constexpr std::size_t read(std::span<char> dest);
+
+    // Returns an iterator to the next character in the stream.
+    // Note that incrementing the iterator consumes the characters from the stream.
+    constexpr Iterator begin()
+    {
+      return Iterator(*this);
+    }
+
+    constexpr std::default_sentinel_t end() const noexcept
+    {
+      return std::default_sentinel;
+    }
+
+  private:
+    // Decodes the next character. The stream must not be done().
+    constexpr char decodeNext()
+    {
+      ++position_;
+      return decoder_->decode();
+    }
+
+    // The decoder; empty if the decompressed data is empty.
+    std::optional<SymbolDecoder> decoder_;
+    // The size of the decompressed data.
+    std::size_t size_ = 0;
+    // The number of characters read so far.
+    std::size_t position_ = 0;
+  };
+
+  template<class SymbolDecoder, DecodePolicy Policy>
+  constexpr DecompressionStream<SymbolDecoder, Policy>::DecompressionStream(std::string_view compressed_data)
+  {
+    // Special case: empty string is decompressed into an empty string.
+    if (compressed_data.empty())
+    {
+      return;
+    }
+    // Read the size of the decompressed data.
+    const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt<Policy::kChecked>(compressed_data);
+    size_ = read_size_result.value;
+    if (size_ != 0)
+    {
+      compressed_data.remove_prefix(read_size_result.num_bytes_read);
+      decoder_.emplace(compressed_data);
+    }
+  }
+
+  template<class SymbolDecoder, DecodePolicy Policy>
+  constexpr std::size_t DecompressionStream<SymbolDecoder, Policy>::read(std::span<char> dest)
+  {
+    const std::size_t num_chars = std::min(dest.size(), remaining());
+    for (std::size_t i = 0; i < num_chars; ++i)
+    {
+      dest[i] = decoder_->decode();
+    }
+    position_ += num_chars;
+    return num_chars;
+  }
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "DecompressionStream.h"
+#include "EnglishCharModel.h"
+#include "internal/ArithmeticCoding.h"
+#include "internal/Exceptions.h"
+#include "internal/HuffmanCode.h"
+#include "internal/IBitStream.h"
+#include "internal/OBitStream.h"
+#include "internal/VarInt.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // Computes the frequencies of characters defined by the given static model.
+    template<class Model>
+    consteval std::array<std::uint64_t, Huffman_NS::HuffmanCodeTraits::kNumSymbols> getCharFrequencies()
+    {
+      std::array<std::uint64_t, Huffman_NS::HuffmanCodeTraits::kNumSymbols> result{};
+      const Model model{};
+      for (std::size_t i = 0; i < result.size(); ++i)
+      {
+        const auto interval = model.getInterval(static_cast<char>(static_cast<unsigned char>(i)));
+        result[i] = interval.second - interval.first;
+      }
+      return result;
+    }
+
+    // Canonical Huffman code and the decoding table for the given static model.
+    template<class Model>
+    class HuffmanTables
+    {
+    public:
+      static constexpr Huffman_NS::CanonicalCode kCode{
+        Huffman_NS::computeCodeLengths(getCharFrequencies<Model>()) };
+      static constexpr Huffman_NS::DecodeTable kDecodeTable = Huffman_NS::makeDecodeTable(kCode);
+
+      // Decodes a code word that is longer than kLookupBits.
+      // \param window - the next kMaxCodeLength bits of the stream.
+      // \return the symbol and the length of its code word.
+      static constexpr std::pair<unsigned char, unsigned int> decodeLongCode(std::uint64_t window)
+      {
+        constexpr unsigned int kMaxCodeLength = Huffman_NS::HuffmanCodeTraits::kMaxCodeLength;
+        for (unsigned int length = Huffman_NS::HuffmanCodeTraits::kLookupBits + 1; length <= kMaxCodeLength; ++length)
+        {
+          const std::uint64_t code = window >> (kMaxCodeLength - length);
+          if (code >= kCode.first_codes[length] && code - kCode.first_codes[length] < kCode.counts[length])
+          {
+            const std::size_t index = kCode.first_indices[length] + (code - kCode.first_codes[length]);
+            return { kCode.sorted_symbols[index], length };
+          }
+        }
+        CTCS_THROW(std::logic_error("HuffmanDecompressor: invalid code word."));
+      }
+    };
+
+    // Decodes the data encoded via a canonical Huffman code one character at a time.
+    template<class Model>
+    class HuffmanSymbolDecoder
+    {
+    public:
+      // \param compressed_data - the encoded data, without the header.
+      explicit constexpr HuffmanSymbolDecoder(std::string_view compressed_data) noexcept:
+        bit_stream_(compressed_data.data(), compressed_data.size())
+      {}
+
+      // Decodes the next character.
+      constexpr char decode()
+      {
+        using Tables = HuffmanTables<Model>;
+        constexpr unsigned int kMaxCodeLength = Huffman_NS::HuffmanCodeTraits::kMaxCodeLength;
+        constexpr unsigned int kLookupBits = Huffman_NS::HuffmanCodeTraits::kLookupBits;
+
+        const std::uint64_t window = bit_stream_.peek(kMaxCodeLength);
+        const Huffman_NS::DecodeTableEntry& entry = Tables::kDecodeTable[window >> (kMaxCodeLength - kLookupBits)];
+        std::pair<unsigned char, unsigned int> decoded(entry.symbols[0], entry.lengths[0]);
+        if (entry.lengths[0] == 0)
+        {
+          // The code word is longer than kLookupBits.
+          decoded = Tables::decodeLongCode(window);
+        }
+        if (bit_stream_.skip(decoded.second) != decoded.second)
+        {
+          CTCS_THROW(std::logic_error("HuffmanDecompressor: unexpected end of stream."));
+        }
+        return static_cast<char>(decoded.first);
+      }
+
+    private:
+      ArithmeticCoding_NS::IBitStream bit_stream_;
+    };
+  }
+
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+  class HuffmanDecompressor
+  {
+  public:
+    // Incremental decompressor.
+    using Stream = DecompressionStream<Detail_NS::HuffmanSymbolDecoder<Model>>;
+
+    // Decompresses the data and appends it to the given std::string.
+    constexpr void operator()(std::string_view compressed_data, std::string& dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return;
+      }
+      const std::size_t offset = dest.size();
+      dest.resize(offset + Detail_NS::readVarInt(compressed_data).value);
+      (*this)(compressed_data, std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      using Tables = Detail_NS::HuffmanTables<Model>;
+      constexpr unsigned int kMaxCodeLength = Huffman_NS::HuffmanCodeTraits::kMaxCodeLength;
+      constexpr unsigned int kLookupBits = Huffman_NS::HuffmanCodeTraits::kLookupBits;
+
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
+      // Read the size of the decompressed data.
+      const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt(compressed_data);
+      const std::size_t decompressed_data_size = read_size_result.value;
+      if (decompressed_data_size > dest.size())
+      {
+        CTCS_THROW(std::length_error("HuffmanDecompressor: the buffer is too small."));
+      }
+      // Discard the bytes we've just read.
+      compressed_data = compressed_data.substr(read_size_result.num_bytes_read);
+      ArithmeticCoding_NS::IBitStream bit_stream(compressed_data.data(), compressed_data.size());
+      std::size_t position = 0;
+      while (position != decompressed_data_size)
+      {
+        const std::uint64_t window = bit_stream.peek(kMaxCodeLength);
+        const Huffman_NS::DecodeTableEntry& entry = Tables::kDecodeTable[window >> (kMaxCodeLength - kLookupBits)];
+        unsigned int num_bits = 0;
+        if (entry.lengths[0] == 0)
+        {
+          // The code word is longer than kLookupBits.
+          const std::pair<unsigned char, unsigned int> decoded = Tables::decodeLongCode(window);
+          dest[position++] = static_cast<char>(decoded.first);
+          num_bits = decoded.second;
+        }
+        else if (entry.lengths[1] != 0 && decompressed_data_size - position >= 2)
+        {
+          dest[position++] = static_cast<char>(entry.symbols[0]);
+          dest[position++] = static_cast<char>(entry.symbols[1]);
+          num_bits = entry.lengths[0] + entry.lengths[1];
+        }
+        else
+        {
+          dest[position++] = static_cast<char>(entry.symbols[0]);
+          num_bits = entry.lengths[0];
+        }
+        if (bit_stream.skip(num_bits) != num_bits)
+        {
+          CTCS_THROW(std::logic_error("HuffmanDecompressor: unexpected end of stream."));
+        }
+      }
+      return decompressed_data_size;
+    }
+  };
+
+  // Compile-time compressor that uses a canonical Huffman code.
+  //
+  // The code is built at compile time from the frequencies of the given static model, and the
+  // decompressor decodes it via a lookup table indexed by the next kLookupBits bits of the stream,
+  // which yields 1 or 2 characters at a time. This is considerably faster than decoding an
+  // arithmetic code, at the cost of a slightly worse compression ratio.
+  // \param Model - static ArithmeticCodingModel, whose frequencies define the Huffman code.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model = EnglishCharModel>
+  class HuffmanCompressor
+  {
+  public:
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+    static_assert(!ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>, "Model should not be adaptive.");
+
+    using Decompressor = HuffmanDecompressor<Model>;
+
+    constexpr std::string operator()(std::string_view data)
+    {
+      constexpr const Huffman_NS::CanonicalCode& kCode = Detail_NS::HuffmanTables<Model>::kCode;
+
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return {};
+      }
+      std::string compressed_data;
+      // Serialize the size of the uncompressed data.
+      Detail_NS::writeVarInt(compressed_data, data.size());
+      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data);
+      for (char c : data)
+      {
+        const std::size_t symbol = static_cast<unsigned char>(c);
+        const unsigned int length = kCode.lengths[symbol];
+        if (length == 0)
+        {
+          CTCS_THROW(std::out_of_range("HuffmanCompressor: the character has zero frequency."));
+        }
+        bit_stream.put(static_cast<std::uint32_t>(kCode.codes[symbol]), length);
+      }
+      bit_stream.finalize();
+      return compressed_data;
+    }
+  };
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "DecompressionStream.h"
+#include "internal/Exceptions.h"
+#include "internal/InterleavedRangeCoder.h"
+#include "internal/InterleavedRangeDecoder.h"
+#include "internal/VarInt.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // Decodes the data encoded via interleaved range coding one character at a time.
+    template<ArithmeticCoding_NS::ArithmeticCodingModel Model, std::size_t NumStates>
+    class InterleavedRangeCodingSymbolDecoder
+    {
+    public:
+      // \param compressed_data - the encoded data, without the header.
+      explicit constexpr InterleavedRangeCodingSymbolDecoder(std::string_view compressed_data) noexcept:
+        decoder_(compressed_data)
+      {}
+
+      // Decodes the next character.
+      constexpr char decode()
+      {
+        const std::size_t state = num_decoded_ % NumStates;
+        if (num_decoded_ < NumStates)
+        {
+          decoder_.start(state);
+        }
+        ++num_decoded_;
+        return decodeWith(state);
+      }
+
+      // Decodes the next NumStates characters, advancing all states in lockstep.
+      // At least NumStates characters must have been decoded via decode(), and the number of decoded
+      // characters must be a multiple of NumStates.
+      constexpr void decodeRound(std::span<char, NumStates> dest)
+      {
+        for (std::size_t state = 0; state < NumStates; ++state)
+        {
+          dest[state] = decodeWith(state);
+        }
+        num_decoded_ += NumStates;
+      }
+
+    private:
+      constexpr char decodeWith(std::size_t state)
+      {
+        const char c = decoder_.decode(model_, state);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model_.update(c);
+        }
+        return c;
+      }
+
+      ArithmeticCoding_NS::InterleavedRangeDecoder<NumStates> decoder_;
+      Model model_ {};
+      // The number of characters decoded so far.
+      std::size_t num_decoded_ = 0;
+    };
+  }
+
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model, std::size_t NumStates>
+  class InterleavedRangeCodingDecompressor
+  {
+  public:
+    // Incremental decompressor.
+    using Stream = DecompressionStream<Detail_NS::InterleavedRangeCodingSymbolDecoder<Model, NumStates>>;
+
+    // Decompresses the data and appends it to the given std::string.
+    constexpr void operator()(std::string_view compressed_data, std::string& dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return;
+      }
+      const std::size_t offset = dest.size();
+      dest.resize(offset + Detail_NS::readVarInt(compressed_data).value);
+      (*this)(compressed_data, std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
+      // Read the size of the decompressed data.
+      const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt(compressed_data);
+      const std::size_t decompressed_data_size = read_size_result.value;
+      if (decompressed_data_size > dest.size())
+      {
+        CTCS_THROW(std::length_error("InterleavedRangeCodingDecompressor: the buffer is too small."));
+      }
+      // Discard the bytes we've just read.
+      compressed_data = compressed_data.substr(read_size_result.num_bytes_read);
+      Detail_NS::InterleavedRangeCodingSymbolDecoder<Model, NumStates> decoder(compressed_data);
+      // The first symbol of each state.
+      std::size_t i = 0;
+      for (; i < std::min(NumStates, decompressed_data_size); ++i)
+      {
+        dest[i] = decoder.decode();
+      }
+      // Full rounds.
+      for (; decompressed_data_size - i >= NumStates; i += NumStates)
+      {
+        decoder.decodeRound(dest.subspan(i).template first<NumStates>());
+      }
+      // The remaining symbols.
+      for (; i < decompressed_data_size; ++i)
+      {
+        dest[i] = decoder.decode();
+      }
+      return decompressed_data_size;
+    }
+  };
+
+  // Compile-time compressor that uses range coding with several interleaved states.
+  //
+  // The symbols are distributed among NumStates independent range coder states, whose outputs
+  // are interleaved into a single stream. Decoding a symbol with one state doesn't depend on the
+  // arithmetic of the others, so the decoder can overlap the work of several states. The compression
+  // ratio is nearly the same as with RangeCodingCompressor: each extra state costs up to
+  // RangeCodingTraits::kCodeValueBytes bytes, and with a single state the output is identical.
+  //
+  // If the model is adaptive, a single model is shared by all states, which limits the overlap.
+  // \param Model - ArithmeticCodingModel to use.
+  // \param NumStates - the number of states, e.g. 2, 4 or 8.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model, std::size_t NumStates = 4>
+  class InterleavedRangeCodingCompressor
+  {
+  public:
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+    static_assert(NumStates >= 1, "NumStates must be positive.");
+
+    using Decompressor = InterleavedRangeCodingDecompressor<Model, NumStates>;
+
+    constexpr std::string operator()(std::string_view data)
+    {
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return {};
+      }
+      std::string compressed_data;
+      // Serialize the size of the uncompressed data.
+      Detail_NS::writeVarInt(compressed_data, data.size());
+      ArithmeticCoding_NS::InterleavedRangeCoder<NumStates> coder(compressed_data);
+      Model model {};
+      for (char c : data)
+      {
+        coder.encode(model, c);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model.update(c);
+        }
+      }
+      coder.finalize();
+      return compressed_data;
+    }
+  };
+}
@@ -0,0 +1,284 @@
+#pragma once
+
+#include "AdaptiveModel.h"
+#include "DecodePolicy.h"
+#include "EnglishCharModel.h"
+#include "internal/ArithmeticCoder.h"
+#include "internal/ArithmeticDecoder.h"
+#include "internal/Exceptions.h"
+#include "internal/LzMatchFinder.h"
+#include "internal/VarInt.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // Models for the tokens of the LZ77 parsing.
+    //
+    // A token is either a literal or a match. Literals are encoded via LiteralModel.
+    // The lengths and the distances of matches are encoded like Elias gamma codes: the number of
+    // significant bits is encoded via an adaptive model, and the remaining bits are encoded as is.
+    template<class LiteralModel>
+    class LzModels
+    {
+    public:
+      using BitClassModel = AdaptiveModel<unsigned char, Lz_NS::LzTraits::kNumBitClasses>;
+      using Decoder = ArithmeticCoding_NS::BasicArithmeticDecoder<CheckedDecode>;
+
+      constexpr void encodeLiteral(ArithmeticCoding_NS::ArithmeticCoder& coder, char c)
+      {
+        encodeIsMatch(coder, false);
+        coder.encode(literal_model_, c);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<LiteralModel>)
+        {
+          literal_model_.update(c);
+        }
+      }
+
+      constexpr void encodeMatch(ArithmeticCoding_NS::ArithmeticCoder& coder, const Lz_NS::Match& match)
+      {
+        encodeIsMatch(coder, true);
+        encodeInteger(coder, length_model_, match.length - Lz_NS::LzTraits::kMinMatchLength + 1);
+        encodeInteger(coder, distance_model_, match.distance);
+      }
+
+      // Decodes the type of the next token.
+      // \return true if the next token is a match, false if it's a literal.
+      constexpr bool decodeIsMatch(Decoder& decoder)
+      {
+        FlagModel& model = flag_models_[previous_is_match_];
+        const bool is_match = decoder.decode(model) != 0;
+        model.update(is_match);
+        previous_is_match_ = is_match;
+        return is_match;
+      }
+
+      constexpr char decodeLiteral(Decoder& decoder)
+      {
+        const char c = decoder.decode(literal_model_);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<LiteralModel>)
+        {
+          literal_model_.update(c);
+        }
+        return c;
+      }
+
+      constexpr Lz_NS::Match decodeMatch(Decoder& decoder)
+      {
+        const std::size_t length = decodeInteger(decoder, length_model_) + Lz_NS::LzTraits::kMinMatchLength - 1;
+        const std::size_t distance = decodeInteger(decoder, distance_model_);
+        return Lz_NS::Match{ .length = length, .distance = distance };
+      }
+
+    private:
+      using FlagModel = AdaptiveModel<unsigned char, 2>;
+
+      constexpr void encodeIsMatch(ArithmeticCoding_NS::ArithmeticCoder& coder, bool is_match)
+      {
+        FlagModel& model = flag_models_[previous_is_match_];
+        coder.encode(model, is_match);
+        model.update(is_match);
+        previous_is_match_ = is_match;
+      }
+
+      // Encodes an integer from [1; 2^kNumBitClasses).
+      static constexpr void encodeInteger(ArithmeticCoding_NS::ArithmeticCoder& coder,
+                                          BitClassModel& model, std::size_t value)
+      {
+        const unsigned char num_extra_bits = static_cast<unsigned char>(std::bit_width(value) - 1);
+        coder.encode(model, num_extra_bits);
+        model.update(num_extra_bits);
+        if (num_extra_bits != 0)
+        {
+          const Lz_NS::UniformModel extra_bits_model(num_extra_bits);
+          coder.encode(extra_bits_model, static_cast<std::uint32_t>(value - (std::size_t{ 1 } << num_extra_bits)));
+        }
+      }
+
+      // Decodes an integer encoded via encodeInteger().
+      static constexpr std::size_t decodeInteger(Decoder& decoder, BitClassModel& model)
+      {
+        const unsigned char num_extra_bits = decoder.decode(model);
+        model.update(num_extra_bits);
+        std::size_t value = std::size_t{ 1 } << num_extra_bits;
+        if (num_extra_bits != 0)
+        {
+          const Lz_NS::UniformModel extra_bits_model(num_extra_bits);
+          value += decoder.decode(extra_bits_model);
+        }
+        return value;
+      }
+
+      // Models for the type of the token, conditioned on the type of the previous token.
+      std::array<FlagModel, 2> flag_models_{};
+      LiteralModel literal_model_{};
+      BitClassModel length_model_{};
+      BitClassModel distance_model_{};
+      bool previous_is_match_ = false;
+    };
+
+    // Copies `length` characters that are `distance` characters back to the position `first`.
+    // The source and the destination may overlap (if distance < length), in which case the
+    // last `distance` characters are repeated. The copy is performed in chunks that don't overlap,
+    // and the size of the chunk doubles at every step.
+    constexpr void copyMatch(char* first, std::size_t length, std::size_t distance)
+    {
+      if (distance >= length)
+      {
+        std::copy_n(first - distance, length, first);
+        return;
+      }
+      std::size_t num_copied = 0;
+      while (num_copied < length)
+      {
+        // The characters before first + num_copied are periodic with the period `distance`,
+        // so they can be copied from any offset that is a multiple of `distance`.
+        const std::size_t period = (distance + num_copied) / distance * distance;
+        const std::size_t chunk_size = std::min(period, length - num_copied);
+        std::copy_n(first + num_copied - period, chunk_size, first + num_copied);
+        num_copied += chunk_size;
+      }
+    }
+  }
+
+  template<ArithmeticCoding_NS::ArithmeticCodingModel LiteralModel>
+  class LzDecompressor
+  {
+  public:
+    // Decompresses the data and appends it to the given std::string.
+    constexpr void operator()(std::string_view compressed_data, std::string& dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return;
+      }
+      const std::size_t offset = dest.size();
+      dest.resize(offset + Detail_NS::readVarInt(compressed_data).value);
+      (*this)(compressed_data, std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
+      // Read the size of the decompressed data.
+      const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt(compressed_data);
+      const std::size_t decompressed_data_size = read_size_result.value;
+      if (decompressed_data_size > dest.size())
+      {
+        CTCS_THROW(std::length_error("LzDecompressor: the buffer is too small."));
+      }
+      // Discard the bytes we've just read.
+      compressed_data = compressed_data.substr(read_size_result.num_bytes_read);
+      ArithmeticCoding_NS::IBitStream bit_stream(compressed_data.data(), compressed_data.size());
+      ArithmeticCoding_NS::BasicArithmeticDecoder<CheckedDecode> decoder(bit_stream);
+      Detail_NS::LzModels<LiteralModel> models{};
+      std::size_t position = 0;
+      while (position != decompressed_data_size)
+      {
+        if (!models.decodeIsMatch(decoder))
+        {
+          dest[position++] = models.decodeLiteral(decoder);
+          continue;
+        }
+        const Lz_NS::Match match = models.decodeMatch(decoder);
+        if (match.distance > position || match.length > decompressed_data_size - position)
+        {
+          CTCS_THROW(std::logic_error("LzDecompressor: invalid match."));
+        }
+        Detail_NS::copyMatch(dest.data() + position, match.length, match.distance);
+        position += match.length;
+      }
+      return decompressed_data_size;
+    }
+  };
+
+  // Compile-time compressor that uses LZ77 with arithmetic coding of the tokens.
+  //
+  // The input is parsed into literals and matches (references to the previous occurrences of the
+  // same substring) via a hash-chain match finder with one step of lazy evaluation. Matches make
+  // repeated fragments (e.g., license headers, generated SQL or HTML templates) almost free,
+  // while the literals are encoded with the given model, like in ArithmeticCodingCompressor.
+  // \param LiteralModel - ArithmeticCodingModel to use for the literals.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel LiteralModel = EnglishCharModel>
+  class LzCompressor
+  {
+  public:
+    static_assert(std::is_default_constructible_v<LiteralModel>, "LiteralModel should be default-constructible.");
+    static_assert(std::is_same_v<typename LiteralModel::char_type, char>, "LiteralModel::char_type should be char.");
+
+    using Decompressor = LzDecompressor<LiteralModel>;
+
+    constexpr std::string operator()(std::string_view data)
+    {
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return {};
+      }
+      std::string compressed_data;
+      // Serialize the size of the uncompressed data.
+      Detail_NS::writeVarInt(compressed_data, data.size());
+      ArithmeticCoding_NS::OBitStream bit_stream(compressed_data);
+      ArithmeticCoding_NS::ArithmeticCoder coder(bit_stream);
+      Detail_NS::LzModels<LiteralModel> models{};
+      Lz_NS::MatchFinder match_finder(data);
+      // The match for position + 1, if it has already been found.
+      Lz_NS::Match next_match{ .length = 0, .distance = 0 };
+      bool has_next_match = false;
+      std::size_t position = 0;
+      while (position < data.size())
+      {
+        const Lz_NS::Match match = has_next_match ? next_match : match_finder.find(position);
+        match_finder.insert(position);
+        has_next_match = false;
+        bool use_match = (match.length != 0);
+        if (use_match)
+        {
+          // Lazy evaluation: emit a literal if there's a longer match at the next position.
+          next_match = match_finder.find(position + 1);
+          has_next_match = true;
+          use_match = (next_match.length <= match.length);
+        }
+        if (use_match)
+        {
+          models.encodeMatch(coder, match);
+          for (std::size_t i = 1; i < match.length; ++i)
+          {
+            match_finder.insert(position + i);
+          }
+          position += match.length;
+          has_next_match = false;
+        }
+        else
+        {
+          models.encodeLiteral(coder, data[position]);
+          ++position;
+        }
+      }
+      coder.finalize();
+      bit_stream.finalize();
+      return compressed_data;
+    }
+  };
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "BlockCompressedString.h"
+#include "internal/Exceptions.h"
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <latch>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ctcs
+{
+  // Executor for decompressParallel(): a callable object that runs the given task,
+  // possibly asynchronously (e.g., by submitting it to a thread pool).
+  template<class Executor>
+  concept TaskExecutor = std::invocable<Executor&, std::function<void()>>;
+
+  namespace Detail_NS
+  {
+    // A loop over [0; num_items), whose iterations can be performed by several threads concurrently.
+    //
+    // Every thread that calls run() takes the next iteration that hasn't been taken yet, until
+    // there are none left. Thus, the work is balanced even if some threads start much later than
+    // the others.
+    // \param Body - callable object that performs an iteration; invoked with the index of the iteration.
+    template<class Body>
+    class ParallelLoop
+    {
+    public:
+      ParallelLoop(std::size_t num_items, Body body) noexcept:
+        num_items_(num_items),
+        body_(std::move(body))
+      {}
+
+      // \return the number of iterations.
+      std::size_t size() const noexcept
+      {
+        return num_items_;
+      }
+
+      // Performs the iterations until there are none left.
+      // If an iteration throws an exception, the exception is stored, and the remaining
+      // iterations are abandoned.
+      void run() noexcept
+      {
+        while (!failed_.load(std::memory_order_relaxed))
+        {
+          const std::size_t index = next_index_.fetch_add(1, std::memory_order_relaxed);
+          if (index >= num_items_)
+          {
+            return;
+          }
+          CTCS_TRY
+          {
+            body_(index);
+          }
+          CTCS_CATCH(...)
+          {
+            if (!failed_.exchange(true))
+            {
+              exception_ = std::current_exception();
+            }
+            return;
+          }
+        }
+      }
+
+      // Rethrows the exception stored by run(), if any.
+      // Must only be called after all calls to run() have returned.
+      void rethrowIfFailed() const
+      {
+        if (exception_)
+        {
+          std::rethrow_exception(exception_);
+        }
+      }
+
+    private:
+      std::size_t num_items_;
+      Body body_;
+      // Index of the next iteration.
+      std::atomic<std::size_t> next_index_ = 0;
+      // True if some iteration has failed.
+      std::atomic<bool> failed_ = false;
+      // The exception thrown by the first failed iteration.
+      std::exception_ptr exception_;
+    };
+
+    // Runs the given loop via the given executor.
+    // Submits up to num_tasks tasks to the executor and blocks until all of them have finished.
+    template<class Body, TaskExecutor Executor>
+    void runParallelLoop(ParallelLoop<Body>& loop, Executor& executor, std::size_t num_tasks)
+    {
+      if (loop.size() == 0)
+      {
+        return;
+      }
+      num_tasks = std::clamp<std::size_t>(num_tasks, 1, loop.size());
+      std::latch num_running_tasks(static_cast<std::ptrdiff_t>(num_tasks));
+      std::size_t num_submitted_tasks = 0;
+      CTCS_TRY
+      {
+        for (; num_submitted_tasks < num_tasks; ++num_submitted_tasks)
+        {
+          executor(std::function<void()>([&loop, &num_running_tasks]()
+          {
+            loop.run();
+            num_running_tasks.count_down();
+          }));
+        }
+      }
+      CTCS_CATCH(...)
+      {
+        // The submitted tasks refer to the local variables, so wait for them before leaving.
+        num_running_tasks.count_down(static_cast<std::ptrdiff_t>(num_tasks - num_submitted_tasks));
+        num_running_tasks.wait();
+        CTCS_RETHROW;
+      }
+      num_running_tasks.wait();
+      loop.rethrowIfFailed();
+    }
+
+    // Runs the given loop on up to num_threads threads, including the calling thread.
+    // If a thread cannot be started, the loop continues on the threads that have been started.
+    // \param num_threads - the maximum number of threads; 0 means std::thread::hardware_concurrency().
+    template<class Body>
+    void runParallelLoop(ParallelLoop<Body>& loop, unsigned int num_threads)
+    {
+      if (num_threads == 0)
+      {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1u);
+      }
+      const std::size_t num_workers = std::min<std::size_t>(num_threads, loop.size());
+      {
+        std::vector<std::jthread> threads;
+        if (num_workers > 1)
+        {
+          threads.reserve(num_workers - 1);
+        }
+        for (std::size_t i = 1; i < num_workers; ++i)
+        {
+          CTCS_TRY
+          {
+            threads.emplace_back([&loop]() { loop.run(); });
+          }
+          CTCS_CATCH(const std::system_error&)
+          {
+            break;
+          }
+        }
+        loop.run();
+        // The threads are joined here.
+      }
+      loop.rethrowIfFailed();
+    }
+
+    // Returns a ParallelLoop that decompresses the blocks of the given BlockCompressedString.
+    // Each block is decompressed straight into its final position in the output buffer.
+    template<class BlockString>
+    auto makeBlockDecompressionLoop(const BlockString& str, std::span<char> dest)
+    {
+      if (dest.size() < str.size())
+      {
+        CTCS_THROW(std::length_error("decompressParallel(): the buffer is too small."));
+      }
+      const auto body = [&str, dest](std::size_t block)
+      {
+        str.decompressBlock(block, dest.subspan(block * BlockString::kBlockSize));
+      };
+      return ParallelLoop<decltype(body)>(BlockString::kNumBlocks, body);
+    }
+  }
+
+  // Decompresses the given BlockCompressedString in parallel via the given executor.
+  //
+  // Submits num_tasks tasks to the executor and blocks until all of them have finished.
+  // The blocks are distributed dynamically among the tasks, and each block is decompressed
+  // straight into its final position in dest.
+  // \param str - the string to decompress.
+  // \param dest - output buffer. Must have at least str.size() elements.
+  // \param executor - executor to run the tasks.
+  // \param num_tasks - the number of tasks to submit; normally, the number of threads of the executor.
+  // \return the number of characters written, i.e. str.size().
+  // \throw std::length_error if the buffer is too small.
+  template<class Model, std::size_t BlockSize, std::size_t CompressedLength, std::size_t DecompressedLength,
+           class OffsetType, class LineCountType, TaskExecutor Executor>
+  std::size_t decompressParallel(
+    const BlockCompressedString<Model, BlockSize, CompressedLength, DecompressedLength, OffsetType, LineCountType>& str,
+    std::span<char> dest, Executor&& executor, std::size_t num_tasks)
+  {
+    auto loop = Detail_NS::makeBlockDecompressionLoop(str, dest);
+    Detail_NS::runParallelLoop(loop, executor, num_tasks);
+    return str.size();
+  }
+
+  // Decompresses the given BlockCompressedString in parallel on a few internal threads.
+  //
+  // The calling thread participates in decompression, and returns after all threads have finished.
+  // If a thread cannot be started, decompression continues on the threads that have been started.
+  // \param str - the string to decompress.
+  // \param dest - output buffer. Must have at least str.size() elements.
+  // \param num_threads - the maximum number of threads to use, including the calling thread.
+  //        0 means std::thread::hardware_concurrency().
+  // \return the number of characters written, i.e. str.size().
+  // \throw std::length_error if the buffer is too small.
+  template<class Model, std::size_t BlockSize, std::size_t CompressedLength, std::size_t DecompressedLength,
+           class OffsetType, class LineCountType>
+  std::size_t decompressParallel(
+    const BlockCompressedString<Model, BlockSize, CompressedLength, DecompressedLength, OffsetType, LineCountType>& str,
+    std::span<char> dest, unsigned int num_threads = 0)
+  {
+    auto loop = Detail_NS::makeBlockDecompressionLoop(str, dest);
+    Detail_NS::runParallelLoop(loop, num_threads);
+    return str.size();
+  }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "ParallelDecompression.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ctcs
+{
+  // Statistics reported by ctcs::prewarm().
+  struct PrewarmStats
+  {
+    // The number of strings decompressed by the call.
+    std::size_t num_strings = 0;
+    // The total size of the strings decompressed by the call.
+    std::size_t num_bytes = 0;
+    // Wall-clock time spent in the call.
+    std::chrono::nanoseconds elapsed {};
+  };
+
+  namespace Detail_NS
+  {
+    // A string registered for ctcs::prewarm().
+    struct PrewarmEntry
+    {
+      // Decompresses the string into its lazy cache.
+      // Returns true if this call has decompressed the string, false if it was already decompressed.
+      bool (*prewarm)();
+      // The size of the decompressed string in bytes.
+      std::size_t size;
+      // The next registered string.
+      PrewarmEntry* next;
+    };
+
+    // Global list of the strings registered for ctcs::prewarm().
+    //
+    // The list is intrusive, and its head is constant-initialized, so strings can be registered
+    // during dynamic initialization of other static variables regardless of the initialization order.
+    class PrewarmRegistry
+    {
+    public:
+      // Adds the given entry to the registry. The entry must outlive the program.
+      // \return true.
+      static bool add(PrewarmEntry& entry) noexcept
+      {
+        entry.next = head_.load(std::memory_order_relaxed);
+        while (!head_.compare_exchange_weak(entry.next, &entry, std::memory_order_release, std::memory_order_relaxed))
+        {
+        }
+        return true;
+      }
+
+      // \return all registered entries.
+      static std::vector<PrewarmEntry*> entries()
+      {
+        std::vector<PrewarmEntry*> result;
+        for (PrewarmEntry* entry = head_.load(std::memory_order_acquire); entry != nullptr; entry = entry->next)
+        {
+          result.push_back(entry);
+        }
+        return result;
+      }
+
+    private:
+      static inline std::atomic<PrewarmEntry*> head_{ nullptr };
+    };
+
+    // Returns a ParallelLoop that decompresses the given registered strings and updates the statistics.
+    inline auto makePrewarmLoop(const std::vector<PrewarmEntry*>& entries,
+                                std::atomic<std::size_t>& num_strings, std::atomic<std::size_t>& num_bytes)
+    {
+      const auto body = [&entries, &num_strings, &num_bytes](std::size_t index)
+      {
+        if (entries[index]->prewarm())
+        {
+          num_strings.fetch_add(1, std::memory_order_relaxed);
+          num_bytes.fetch_add(entries[index]->size, std::memory_order_relaxed);
+        }
+      };
+      return ParallelLoop<decltype(body)>(entries.size(), body);
+    }
+
+    // Decompresses all registered strings via the given function, which runs a ParallelLoop.
+    template<class RunLoop>
+    PrewarmStats prewarmImpl(RunLoop run_loop)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      const std::vector<PrewarmEntry*> entries = PrewarmRegistry::entries();
+      std::atomic<std::size_t> num_strings = 0;
+      std::atomic<std::size_t> num_bytes = 0;
+      auto loop = makePrewarmLoop(entries, num_strings, num_bytes);
+      run_loop(loop);
+      PrewarmStats stats;
+      stats.num_strings = num_strings.load(std::memory_order_relaxed);
+      stats.num_bytes = num_bytes.load(std::memory_order_relaxed);
+      stats.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      return stats;
+    }
+  }
+
+  // Decompresses all strings registered via ctcs::prewarmed() into their lazy caches, in parallel
+  // via the given executor. Subsequent calls to ctcs::prewarmed() or ctcs::lazy() for these strings
+  // only perform an atomic load.
+  //
+  // Submits up to num_tasks tasks to the executor and blocks until all of them have finished.
+  // Strings that have already been decompressed are skipped.
+  // \param executor - executor to run the tasks.
+  // \param num_tasks - the number of tasks to submit; normally, the number of threads of the executor.
+  // \return the number of strings and bytes decompressed by this call, and the time it took.
+  template<TaskExecutor Executor>
+  PrewarmStats prewarm(Executor&& executor, std::size_t num_tasks = std::thread::hardware_concurrency())
+  {
+    return Detail_NS::prewarmImpl([&executor, num_tasks](auto& loop)
+    {
+      Detail_NS::runParallelLoop(loop, executor, num_tasks);
+    });
+  }
+
+  // Decompresses all strings registered via ctcs::prewarmed() into their lazy caches, in parallel
+  // on a few internal threads. The calling thread participates in decompression.
+  // \param num_threads - the maximum number of threads to use, including the calling thread.
+  //        0 means std::thread::hardware_concurrency().
+  // \return the number of strings and bytes decompressed by this call, and the time it took.
+  inline PrewarmStats prewarm(unsigned int num_threads = 0)
+  {
+    return Detail_NS::prewarmImpl([num_threads](auto& loop)
+    {
+      Detail_NS::runParallelLoop(loop, num_threads);
+    });
+  }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "DecompressionStream.h"
+#include "internal/Exceptions.h"
+#include "internal/RangeCoder.h"
+#include "internal/RangeDecoder.h"
+#include "internal/VarInt.h"
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // Decodes the data encoded via range coding one character at a time.
+    template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+    class RangeCodingSymbolDecoder
+    {
+    public:
+      // \param compressed_data - the encoded data, without the header.
+      explicit constexpr RangeCodingSymbolDecoder(std::string_view compressed_data):
+        decoder_(compressed_data)
+      {}
+
+      // Decodes the next character.
+      constexpr char decode()
+      {
+        const char c = decoder_.decode(model_);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model_.update(c);
+        }
+        return c;
+      }
+
+    private:
+      ArithmeticCoding_NS::RangeDecoder decoder_;
+      Model model_ {};
+    };
+  }
+
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+  class RangeCodingDecompressor
+  {
+  public:
+    // Incremental decompressor.
+    using Stream = DecompressionStream<Detail_NS::RangeCodingSymbolDecoder<Model>>;
+
+    // Decompresses the data and appends it to the given std::string.
+    constexpr void operator()(std::string_view compressed_data, std::string& dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return;
+      }
+      const std::size_t offset = dest.size();
+      dest.resize(offset + Detail_NS::readVarInt(compressed_data).value);
+      (*this)(compressed_data, std::span<char>(dest).subspan(offset));
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<char> dest)
+    {
+      // Special case: empty string is decompressed into an empty string.
+      if (compressed_data.empty())
+      {
+        return 0;
+      }
+      // Read the size of the decompressed data.
+      const Detail_NS::ReadVarIntResult read_size_result = Detail_NS::readVarInt(compressed_data);
+      const std::size_t decompressed_data_size = read_size_result.value;
+      if (decompressed_data_size > dest.size())
+      {
+        CTCS_THROW(std::length_error("RangeCodingDecompressor: the buffer is too small."));
+      }
+      // Discard the bytes we've just read.
+      compressed_data = compressed_data.substr(read_size_result.num_bytes_read);
+      if (decompressed_data_size == 0)
+      {
+        return 0;
+      }
+      Detail_NS::RangeCodingSymbolDecoder<Model> decoder(compressed_data);
+      for (std::size_t i = 0; i < decompressed_data_size; ++i)
+      {
+        dest[i] = decoder.decode();
+      }
+      return decompressed_data_size;
+    }
+  };
+
+  // Compile-time compressor that uses range coding.
+  //
+  // Range coding is a variant of arithmetic coding that renormalizes a byte at a time,
+  // which makes decompression considerably faster than with ArithmeticCodingCompressor.
+  // The compression ratio is nearly the same.
+  // \param Model - ArithmeticCodingModel to use.
+  template<ArithmeticCoding_NS::ArithmeticCodingModel Model>
+  class RangeCodingCompressor
+  {
+  public:
+    static_assert(std::is_default_constructible_v<Model>, "Model should be default-constructible.");
+    static_assert(std::is_same_v<typename Model::char_type, char>, "Model::char_type should be char.");
+
+    using Decompressor = RangeCodingDecompressor<Model>;
+
+    constexpr std::string operator()(std::string_view data)
+    {
+      // Special case: empty string is compressed into an empty string.
+      if (data.empty())
+      {
+        return {};
+      }
+      std::string compressed_data;
+      // Serialize the size of the uncompressed data.
+      Detail_NS::writeVarInt(compressed_data, data.size());
+      ArithmeticCoding_NS::RangeCoder coder(compressed_data);
+      Model model {};
+      for (char c : data)
+      {
+        coder.encode(model, c);
+        if constexpr (ArithmeticCoding_NS::AdaptiveArithmeticCodingModel<Model>)
+        {
+          model.update(c);
+        }
+      }
+      coder.finalize();
+      return compressed_data;
+    }
+  };
+}
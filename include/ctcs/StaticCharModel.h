@@ -0,0 +1,123 @@
+#pragma once
+
+#include "DecodePolicy.h"
+#include "internal/ArithmeticCoding.h"
+#include "internal/Exceptions.h"
+#include "internal/SymbolLookupTable.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    template<class T, std::size_t N>
+    constexpr std::array<T, N> makeFrequenciesSafe(std::span<const T, N> frequencies)
+    {
+      std::array<T, N> result{};
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        result[i] = std::max(frequencies[i], T{ 1 });
+      }
+      return result;
+    }
+
+    template<class T, std::size_t N>
+    constexpr std::array<T, N+1> makeCumulativeHistogram(std::span<const T, N> frequencies)
+    {
+      std::array<T, N + 1> result{};
+      T partial_sum {};
+      for (std::size_t i = 0; i < N; ++i)
+      {
+        result[i] = partial_sum;
+        partial_sum += frequencies[i];
+      }
+      result[N] = partial_sum;
+      return result;
+    }
+  }
+  // Static ArithmeticCodingModel for encoding char elements.
+  //
+  // The distribution of characters is defined by the given table of frequencies, which
+  // is turned into cumulative frequencies at compile time. Characters with zero frequency
+  // are treated as if their frequency was 1, so any character can be encoded.
+  // \param Frequencies - the number of occurrences of each character, indexed by the
+  //        character reinterpreted as unsigned char.
+  template<std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, 256> Frequencies>
+  class StaticCharModel
+  {
+    static constexpr std::uint32_t kNumCharacters = 256;
+
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+    using char_type = char;
+
+    constexpr FrequencyCount scalingFactor() const noexcept
+    {
+      return kCumulativeFrequencies[kNumCharacters];
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    constexpr char_type getCharByPoint(FrequencyCount value) const
+    {
+      return static_cast<char_type>(findIndex<CheckedDecode>(value));
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    // \return the character and its interval.
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value) const
+    {
+      return decodeSymbol(value, CheckedDecode{});
+    }
+
+    // Same as above, but with TrustedDecode the value is trusted to be less than scalingFactor(),
+    // and isn't checked.
+    template<DecodePolicy Policy>
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value, Policy) const
+    {
+      const std::size_t index = findIndex<Policy>(value);
+      return { static_cast<char_type>(index), { kCumulativeFrequencies[index], kCumulativeFrequencies[index + 1] } };
+    }
+
+    // Returns the interval for the specified character.
+    constexpr std::pair<FrequencyCount, FrequencyCount> getInterval(char_type character) const
+    {
+      const std::size_t index = static_cast<std::size_t>(static_cast<unsigned char>(character));
+      if (index >= kNumCharacters)
+      {
+        CTCS_THROW(std::out_of_range("StaticCharModel::getInterval(): character is out of range."));
+      }
+      return { kCumulativeFrequencies[index], kCumulativeFrequencies[index + 1] };
+    }
+
+  private:
+    // \return index i such that kCumulativeFrequencies[i] <= value < kCumulativeFrequencies[i + 1].
+    template<DecodePolicy Policy>
+    static constexpr std::size_t findIndex(FrequencyCount value)
+    {
+      if constexpr (Policy::kChecked)
+      {
+        if (value >= kCumulativeFrequencies[kNumCharacters])
+        {
+          CTCS_THROW(std::out_of_range("StaticCharModel::getCharByPoint(): value is out of range."));
+        }
+      }
+      return kSymbolLookupTable.find(kCumulativeFrequencies, value);
+    }
+
+    static constexpr std::array<FrequencyCount, kNumCharacters + 1> kCumulativeFrequencies =
+      Detail_NS::makeCumulativeHistogram(std::span<const FrequencyCount, kNumCharacters>(
+        Detail_NS::makeFrequenciesSafe(std::span<const FrequencyCount, kNumCharacters>(Frequencies))));
+
+    static_assert(kCumulativeFrequencies[kNumCharacters] <= ArithmeticCoding_NS::ArithmeticCodingTraits::kMaxFrequency,
+      "The sum of frequencies must not exceed kMaxFrequency.");
+
+    // Reverse lookup table for kCumulativeFrequencies.
+    static constexpr Detail_NS::SymbolLookupTable<kNumCharacters> kSymbolLookupTable{ kCumulativeFrequencies };
+  };
+}
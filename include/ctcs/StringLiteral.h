@@ -1,16 +1,26 @@
 #pragma once
 
+#include <bit>
 #include <cstddef>
 #include <string_view>
 
 namespace ctcs
 {
+  namespace Detail_NS
+  {
+    template<std::size_t Length, class CharT>
+    struct NullTerminatedStringLiteral;
+  }
+
   // String-like class whose objects can only be constructed at compile time.
-  // TODO: specialize for Length==0
-  template<std::size_t Length>
+  // \param Length - the number of characters in the string.
+  // \param CharT - character type: char, char8_t, char16_t, char32_t or wchar_t.
+  template<std::size_t Length, class CharT = char>
   class StringLiteral
   {
   public:
+    using char_type = CharT;
+
     // Constructs a zero-initialized StringLiteral.
     constexpr StringLiteral() noexcept:
       data{}
@@ -18,13 +28,12 @@ namespace ctcs
 
     // Constructs a StringLiteral from a built-in string literal.
     // Note that the last character - the null terminator - is not copied.
+    // The string is copied as a whole rather than character by character, so that large literals
+    // (e.g., the ones generated by ctcs_pack) don't hit the compiler's limits on constant evaluation.
     // \param str - input string literal.
-    constexpr StringLiteral(const char (&str)[Length + 1]) noexcept
+    constexpr StringLiteral(const CharT (&str)[Length + 1]) noexcept:
+      StringLiteral(std::bit_cast<Detail_NS::NullTerminatedStringLiteral<Length, CharT>>(str).str)
     {
-      for (std::size_t i = 0; i < Length; ++i)
-      {
-        data[i] = str[i];
-      }
     }
 
     // \return the size of the string.
@@ -33,27 +42,29 @@ namespace ctcs
       return Length;
     }
 
-    // \return a std::string_view into this string.
-    constexpr std::string_view view() const noexcept
+    // \return a std::basic_string_view into this string.
+    constexpr std::basic_string_view<CharT> view() const noexcept
     {
-      return std::string_view(data, Length);
+      return std::basic_string_view<CharT>(data, Length);
     }
 
-    char data[Length];
+    CharT data[Length];
   };
 
   // Specialization for Length==0.
-  template<>
-  class StringLiteral<0>
+  template<class CharT>
+  class StringLiteral<0, CharT>
   {
   public:
+    using char_type = CharT;
+
     // Constructs a zero-initialized StringLiteral.
     constexpr StringLiteral() noexcept = default;
 
     // Constructs a StringLiteral from a built-in string literal.
     // Note that the last character - the null terminator - is not copied.
     // \param str - input string literal.
-    constexpr StringLiteral(const char(&)[1]) noexcept
+    constexpr StringLiteral(const CharT(&)[1]) noexcept
     {
     }
 
@@ -63,16 +74,27 @@ namespace ctcs
       return 0;
     }
 
-    // \return a std::string_view into this string.
-    constexpr std::string_view view() const noexcept
+    // \return a std::basic_string_view into this string.
+    constexpr std::basic_string_view<CharT> view() const noexcept
     {
       return {};
     }
 
-    char data[1]{};
+    CharT data[1]{};
   };
 
+  namespace Detail_NS
+  {
+    // The object representation of a string literal with its null terminator.
+    template<std::size_t Length, class CharT>
+    struct NullTerminatedStringLiteral
+    {
+      StringLiteral<Length, CharT> str;
+      CharT null_terminator;
+    };
+  }
+
   // Deduction guides for StringLiteral.
-  template <std::size_t N> StringLiteral(const char(&)[N]) -> StringLiteral<N - 1>;
-  template <std::size_t N> StringLiteral(StringLiteral<N>) -> StringLiteral<N>;
+  template <class CharT, std::size_t N> StringLiteral(const CharT(&)[N]) -> StringLiteral<N - 1, CharT>;
+  template <std::size_t N, class CharT> StringLiteral(StringLiteral<N, CharT>) -> StringLiteral<N, CharT>;
 }
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "StaticCharModel.h"
+#include "StringLiteral.h"
+#include "internal/ArithmeticCoding.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // Every occurrence of a character in the samples of TrainedCharModel increases its frequency by this value.
+    inline constexpr ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount kObservedCharWeight = 16;
+
+    // Counts the occurrences of each character in the given samples.
+    // \param weight - every occurrence adds this value to the frequency of the character.
+    // \return frequencies of characters, indexed by the character reinterpreted as unsigned char.
+    template<StringLiteral... Corpus>
+    consteval std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, 256>
+    countCharFrequencies(ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount weight)
+    {
+      std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, 256> result{};
+      for (std::string_view sample : { Corpus.view()... })
+      {
+        for (char c : sample)
+        {
+          result[static_cast<unsigned char>(c)] += weight;
+        }
+      }
+      return result;
+    }
+  }
+
+  // ArithmeticCodingModel for encoding char elements, whose distribution is computed at compile time
+  // from the given samples.
+  //
+  // Characters that don't occur in the samples can still be encoded, but are assumed to be
+  // kObservedCharWeight times less likely than the ones that occur exactly once.
+  //
+  // Usage:
+  //   constexpr ctcs::StringLiteral kCorpus = "SELECT * FROM users WHERE id = ?;";
+  //   using SqlModel = ctcs::TrainedCharModel<kCorpus>;
+  //   constexpr auto kQuery = ctcs::compress<"SELECT name FROM users;", ctcs::ArithmeticCodingCompressor<SqlModel>>();
+  // \param Corpus - sample strings.
+  template<StringLiteral... Corpus>
+  class TrainedCharModel : public StaticCharModel<Detail_NS::countCharFrequencies<Corpus...>(Detail_NS::kObservedCharWeight)>
+  {
+  public:
+    // Every occurrence of a character in the samples increases its frequency by this value.
+    static constexpr ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount kObservedCharWeight =
+      Detail_NS::kObservedCharWeight;
+
+    static_assert(sizeof...(Corpus) > 0, "At least one sample is required.");
+    static_assert(((Corpus.size() * std::uint64_t{ kObservedCharWeight }) + ... + 256) <=
+                  ArithmeticCoding_NS::ArithmeticCodingTraits::kMaxFrequency,
+                  "The corpus is too big.");
+  };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "ArithmeticCodingCompressor.h"
+#include "DecodePolicy.h"
+#include "Utf8Model.h"
+#include "internal/Exceptions.h"
+#include "internal/Utf8.h"
+
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs
+{
+  // Decompressor for UnicodeCompressor.
+  //
+  // Decompresses the UTF-8 representation of the string, and converts it back to CharT.
+  // If Decompressor defines the type Stream, no memory is allocated.
+  // TrustedDecode is supported if Decompressor defines the type TrustedStream.
+  // \param CharT - character type: char8_t, char16_t, char32_t or wchar_t.
+  // \param Decompressor - decompressor for the UTF-8 representation.
+  template<class CharT, class Decompressor>
+  class UnicodeDecompressor
+  {
+  public:
+    using char_type = CharT;
+
+    // Decompresses the data and appends it to the given string.
+    constexpr void operator()(std::string_view compressed_data, std::basic_string<CharT>& dest)
+    {
+      decode<CheckedDecode>(compressed_data, [&dest](CharT c) { dest.push_back(c); });
+    }
+
+    // Decompresses the data into the given buffer.
+    // \param compressed_data - compressed data.
+    // \param dest - output buffer. Must be large enough to store the decompressed data.
+    // \return the size of the decompressed data.
+    // \throw std::length_error if the buffer is too small.
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<CharT> dest)
+    {
+      return (*this)(compressed_data, dest, CheckedDecode{});
+    }
+
+    // Decompresses the data into the given buffer with the given DecodePolicy.
+    // With TrustedDecode, the data (including its UTF-8 representation) is not checked, but the
+    // size of the buffer still is.
+    template<DecodePolicy Policy>
+    constexpr std::size_t operator()(std::string_view compressed_data, std::span<CharT> dest, Policy)
+      requires (Policy::kChecked || requires { typename Decompressor::TrustedStream; })
+    {
+      std::size_t size = 0;
+      decode<Policy>(compressed_data, [&dest, &size](CharT c)
+      {
+        if (size == dest.size())
+        {
+          CTCS_THROW(std::length_error("UnicodeDecompressor: the buffer is too small."));
+        }
+        dest[size++] = c;
+      });
+      return size;
+    }
+
+  private:
+    // Decompresses the data, passing every decoded character to the given function.
+    // \throw std::runtime_error if Policy is CheckedDecode and the decompressed data is not valid UTF-8.
+    template<DecodePolicy Policy, class Sink>
+    static constexpr void decode(std::string_view compressed_data, Sink sink)
+    {
+      if constexpr (std::is_same_v<CharT, char8_t>)
+      {
+        decodeBytes<Policy>(compressed_data, [&sink](char byte) { sink(static_cast<char8_t>(byte)); });
+      }
+      else
+      {
+        Detail_NS::Utf8Decoder<CharT, Policy::kChecked> decoder;
+        decodeBytes<Policy>(compressed_data, [&sink, &decoder](char byte)
+        {
+          const typename Detail_NS::Utf8Decoder<CharT, Policy::kChecked>::Output output = decoder.push(byte);
+          for (std::size_t i = 0; i < output.size; ++i)
+          {
+            sink(output.code_units[i]);
+          }
+        });
+        if constexpr (Policy::kChecked)
+        {
+          if (!decoder.complete())
+          {
+            CTCS_THROW(std::runtime_error("UnicodeDecompressor: truncated UTF-8 sequence."));
+          }
+        }
+      }
+    }
+
+    // Decompresses the UTF-8 representation, passing every byte to the given function.
+    template<DecodePolicy Policy, class ByteSink>
+    static constexpr void decodeBytes(std::string_view compressed_data, ByteSink byte_sink)
+    {
+      if constexpr (!Policy::kChecked)
+      {
+        typename Decompressor::TrustedStream stream(compressed_data);
+        for (char byte : stream)
+        {
+          byte_sink(byte);
+        }
+      }
+      else if constexpr (requires { typename Decompressor::Stream; })
+      {
+        typename Decompressor::Stream stream(compressed_data);
+        for (char byte : stream)
+        {
+          byte_sink(byte);
+        }
+      }
+      else
+      {
+        std::string utf8;
+        Decompressor{}(compressed_data, utf8);
+        for (char byte : utf8)
+        {
+          byte_sink(byte);
+        }
+      }
+    }
+  };
+
+  // Compressor for strings of characters other than char.
+  //
+  // The string is converted into UTF-8 (see Detail_NS::toUtf8()), which is then compressed with the given
+  // compressor. ctcs::compress() uses this class automatically for u8"", u"", U"" and L"" literals.
+  // \param CharT - character type: char8_t, char16_t, char32_t or wchar_t.
+  // \param Compressor - compressor for the UTF-8 representation.
+  template<class CharT, class Compressor = ArithmeticCodingCompressor<Utf8Model<>>>
+  class UnicodeCompressor
+  {
+  public:
+    static_assert(!std::is_same_v<CharT, char>, "char strings should be compressed with Compressor directly.");
+
+    using Decompressor = UnicodeDecompressor<CharT, typename Compressor::Decompressor>;
+
+    // \throw std::invalid_argument if data is not a valid UTF-16/UTF-32 string.
+    constexpr std::string operator()(std::basic_string_view<CharT> data)
+    {
+      return Compressor{}(Detail_NS::toUtf8(data));
+    }
+  };
+}
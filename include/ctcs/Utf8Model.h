@@ -0,0 +1,256 @@
+#pragma once
+
+#include "AdaptiveModel.h"
+#include "DecodePolicy.h"
+#include "EnglishCharModel.h"
+#include "internal/ArithmeticCoding.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+
+namespace ctcs
+{
+  namespace Detail_NS
+  {
+    // The number of byte values.
+    inline constexpr std::size_t kNumByteValues = 256;
+
+    // Initial frequencies for the bytes that start a character in UTF-8 text.
+    //
+    // ASCII characters are distributed like in English text (spaces, digits and punctuation are shared
+    // by most languages); lead bytes of multi-byte sequences get a fixed weight; continuation bytes
+    // and the bytes that never occur in UTF-8 get the minimum weight.
+    // \param lead_byte_weight - the weight of a lead byte of a 2- or 3-byte sequence.
+    constexpr std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues>
+    makeUtf8LeadFrequencies(ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount lead_byte_weight)
+    {
+      using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+      // The weight of the most frequent ASCII character.
+      constexpr std::uint64_t kMaxAsciiWeight = 192;
+      FrequencyCount max_frequency = 0;
+      for (std::size_t i = 0; i < 0x80; ++i)
+      {
+        max_frequency = std::max(max_frequency, kBrownCorpusCharFrequencies[i]);
+      }
+      std::array<FrequencyCount, kNumByteValues> result{};
+      for (std::size_t i = 0; i < kNumByteValues; ++i)
+      {
+        if (i < 0x80)
+        {
+          result[i] = static_cast<FrequencyCount>(1 + kBrownCorpusCharFrequencies[i] * kMaxAsciiWeight / max_frequency);
+        }
+        else if (i >= 0xC2 && i <= 0xEF)
+        {
+          result[i] = lead_byte_weight;
+        }
+        else if (i >= 0xF0 && i <= 0xF4)
+        {
+          // 4-byte sequences (emoji, historic scripts) are much rarer.
+          result[i] = std::max<FrequencyCount>(lead_byte_weight / 8, 1);
+        }
+        else
+        {
+          result[i] = 1;
+        }
+      }
+      return result;
+    }
+
+    // Initial frequencies for the continuation bytes of UTF-8 sequences.
+    constexpr std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues>
+    makeUtf8ContinuationFrequencies()
+    {
+      std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues> result{};
+      for (std::size_t i = 0; i < kNumByteValues; ++i)
+      {
+        result[i] = (i >= 0x80 && i <= 0xBF) ? 32 : 1;
+      }
+      return result;
+    }
+
+    inline constexpr std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues>
+      kUtf8LeadFrequencies = makeUtf8LeadFrequencies(24);
+    inline constexpr std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues>
+      kUtf8LeadAfterMultiByteFrequencies = makeUtf8LeadFrequencies(64);
+    inline constexpr std::array<ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount, kNumByteValues>
+      kUtf8ContinuationFrequencies = makeUtf8ContinuationFrequencies();
+
+    // The initial distributions of Utf8Model. They are built at compile time, so that constructing
+    // Utf8Model neither rebuilds the Fenwick trees nor validates the frequencies at runtime.
+    inline constexpr AdaptiveCharModel kUtf8LeadModel{ std::span(kUtf8LeadFrequencies) };
+    inline constexpr AdaptiveCharModel kUtf8LeadAfterMultiByteModel{ std::span(kUtf8LeadAfterMultiByteFrequencies) };
+    inline constexpr AdaptiveCharModel kUtf8ContinuationModel{ std::span(kUtf8ContinuationFrequencies) };
+  }
+
+  // Adaptive ArithmeticCodingModel for encoding UTF-8 text byte by byte.
+  //
+  // Unlike EnglishCharModel, which assumes that non-ASCII bytes almost never occur, this model
+  // follows the structure of UTF-8: every byte is predicted by a separate adaptive distribution,
+  // chosen depending on whether the byte starts a character or continues a multi-byte one.
+  // * The first byte of a character is predicted by one of 2 distributions: after an ASCII character,
+  //   or after a multi-byte one (text in a non-Latin script mostly stays in that script).
+  // * A continuation byte is predicted by one of 2^LogNumContexts distributions, chosen by the previous
+  //   byte and the position within the sequence. E.g., the second byte of a Cyrillic character
+  //   is predicted separately after 0xD0 and after 0xD1.
+  // Initially, the lead bytes are only a few times less likely than the common ASCII letters, and
+  // any of the 64 continuation bytes costs about 6 bits, so German, Russian or Japanese strings
+  // shrink even if they are short. Invalid UTF-8 can still be encoded, but is expensive.
+  //
+  // The model doesn't need any precomputed tables: it's built from scratch by both the compressor
+  // and the decompressor.
+  // \param LogNumContexts - binary logarithm of the number of distributions for continuation bytes.
+  template<unsigned int LogNumContexts = 4>
+  class Utf8Model
+  {
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+    using char_type = char;
+
+    static_assert(LogNumContexts > 0 && LogNumContexts <= 8, "LogNumContexts must be within [1; 8].");
+
+    constexpr FrequencyCount scalingFactor() const noexcept
+    {
+      return currentModel().scalingFactor();
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    constexpr char_type getCharByPoint(FrequencyCount value) const
+    {
+      return currentModel().getCharByPoint(value);
+    }
+
+    // Find the character, whose interval [lower, upper) contains the specified value.
+    // \return the character and its interval.
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value) const
+    {
+      return currentModel().decodeSymbol(value);
+    }
+
+    // Same as above, but with TrustedDecode the value is trusted to be less than scalingFactor(),
+    // and isn't checked.
+    template<DecodePolicy Policy>
+    constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value, Policy policy) const
+    {
+      return currentModel().decodeSymbol(value, policy);
+    }
+
+    // Returns the interval for the specified character.
+    constexpr std::pair<FrequencyCount, FrequencyCount> getInterval(char_type character) const
+    {
+      return currentModel().getInterval(character);
+    }
+
+    // Updates the model after encoding/decoding the specified character.
+    constexpr void update(char_type character);
+
+    // Restores the state of a default-constructed model. Only the distributions that have been
+    // updated are restored, so this is much cheaper than assigning a new model after a short string.
+    constexpr void reset() noexcept;
+
+  private:
+    static constexpr std::size_t kNumContinuationContexts = std::size_t{ 1 } << LogNumContexts;
+    // The number of 64-bit words in used_continuation_models_.
+    static constexpr std::size_t kNumUsedContinuationWords = (kNumContinuationContexts + 63) / 64;
+
+    // \return the distribution for the next byte.
+    constexpr const AdaptiveCharModel& currentModel() const noexcept
+    {
+      if (num_remaining_bytes_ != 0)
+      {
+        return continuation_models_[continuation_context_];
+      }
+      return after_multi_byte_ ? lead_after_multi_byte_model_ : lead_model_;
+    }
+
+    // The distribution for the first byte of a character after an ASCII character.
+    AdaptiveCharModel lead_model_ = Detail_NS::kUtf8LeadModel;
+    // The distribution for the first byte of a character after a multi-byte character.
+    AdaptiveCharModel lead_after_multi_byte_model_ = Detail_NS::kUtf8LeadAfterMultiByteModel;
+    // The distributions for continuation bytes.
+    std::array<AdaptiveCharModel, kNumContinuationContexts> continuation_models_ = []()
+    {
+      std::array<AdaptiveCharModel, kNumContinuationContexts> models;
+      models.fill(Detail_NS::kUtf8ContinuationModel);
+      return models;
+    }();
+    // The number of continuation bytes expected until the end of the current character.
+    unsigned int num_remaining_bytes_ = 0;
+    // Index of the distribution for the next continuation byte.
+    std::size_t continuation_context_ = 0;
+    // True if the last complete character was a multi-byte one.
+    bool after_multi_byte_ = false;
+    // Bit i is set if continuation_models_[i] has been updated since the construction or the last reset().
+    std::array<std::uint64_t, kNumUsedContinuationWords> used_continuation_models_{};
+  };
+
+  template<unsigned int LogNumContexts>
+  constexpr void Utf8Model<LogNumContexts>::update(char_type character)
+  {
+    const unsigned char byte = static_cast<unsigned char>(character);
+    if (num_remaining_bytes_ != 0)
+    {
+      continuation_models_[continuation_context_].update(character);
+      used_continuation_models_[continuation_context_ / 64] |= std::uint64_t{ 1 } << (continuation_context_ % 64);
+      if ((byte & 0xC0) != 0x80)
+      {
+        // Invalid UTF-8: start over.
+        num_remaining_bytes_ = 0;
+        after_multi_byte_ = false;
+        return;
+      }
+      --num_remaining_bytes_;
+      after_multi_byte_ = true;
+    }
+    else
+    {
+      (after_multi_byte_ ? lead_after_multi_byte_model_ : lead_model_).update(character);
+      if (byte >= 0xC2 && byte <= 0xDF)
+      {
+        num_remaining_bytes_ = 1;
+      }
+      else if (byte >= 0xE0 && byte <= 0xEF)
+      {
+        num_remaining_bytes_ = 2;
+      }
+      else if (byte >= 0xF0 && byte <= 0xF4)
+      {
+        num_remaining_bytes_ = 3;
+      }
+      else
+      {
+        after_multi_byte_ = false;
+      }
+    }
+    if (num_remaining_bytes_ != 0)
+    {
+      // Fibonacci hashing of the previous byte and the position within the sequence.
+      constexpr std::uint32_t kMultiplier = 2654435769u;
+      const std::uint32_t key = (std::uint32_t{ byte } << 2) | num_remaining_bytes_;
+      continuation_context_ = static_cast<std::size_t>(static_cast<std::uint32_t>(key * kMultiplier) >> (32 - LogNumContexts));
+    }
+  }
+
+  template<unsigned int LogNumContexts>
+  constexpr void Utf8Model<LogNumContexts>::reset() noexcept
+  {
+    lead_model_ = Detail_NS::kUtf8LeadModel;
+    lead_after_multi_byte_model_ = Detail_NS::kUtf8LeadAfterMultiByteModel;
+    for (std::size_t word = 0; word < kNumUsedContinuationWords; ++word)
+    {
+      for (std::uint64_t bits = used_continuation_models_[word]; bits != 0; bits &= bits - 1)
+      {
+        continuation_models_[word * 64 + static_cast<std::size_t>(std::countr_zero(bits))] =
+          Detail_NS::kUtf8ContinuationModel;
+      }
+      used_continuation_models_[word] = 0;
+    }
+    num_remaining_bytes_ = 0;
+    continuation_context_ = 0;
+    after_multi_byte_ = false;
+  }
+}
@@ -1,30 +1,272 @@
 #pragma once
 
+#include "AdaptiveModel.h"
 #include "ArithmeticCodingCompressor.h"
+#include "ArithmeticCodingRuntimeCompressor.h"
+#include "BinaryCompressor.h"
+#include "BlockCompressedString.h"
+#include "CompressedBytes.h"
 #include "CompressedString.h"
+#include "CompressedStringTable.h"
+#include "ContextModel.h"
+#include "DecodeObserver.h"
+#include "DecodePolicy.h"
+#include "DecodeProfiler.h"
+#include "DecompressionStream.h"
 #include "EnglishCharModel.h"
+#include "HuffmanCompressor.h"
+#include "InterleavedRangeCodingCompressor.h"
+#include "LzCompressor.h"
+#include "ParallelDecompression.h"
+#include "Prewarm.h"
+#include "RangeCodingCompressor.h"
+#include "StaticCharModel.h"
 #include "StringLiteral.h"
+#include "TrainedCharModel.h"
+#include "UnicodeCompressor.h"
+#include "Utf8Model.h"
+#include "internal/CompileTimeBuffer.h"
+#include "internal/Exceptions.h"
 
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <span>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 
 // ctcs = Compile-time Compressed String.
 namespace ctcs
 {
+  namespace Detail_NS
+  {
+    // The default compressor for strings of the given character type.
+    template<class CharT>
+    using DefaultCompressor = std::conditional_t<std::is_same_v<CharT, char>,
+                                                 ArithmeticCodingCompressor<EnglishCharModel>,
+                                                 ArithmeticCodingCompressor<Utf8Model<>>>;
+
+    // The compressor that ctcs::compress() actually uses for strings of the given character type:
+    // strings of characters other than char are converted into UTF-8 via UnicodeCompressor.
+    template<class CharT, class Compressor>
+    using CompressorFor = std::conditional_t<std::is_same_v<CharT, char>, Compressor, UnicodeCompressor<CharT, Compressor>>;
+
+    // Checks that the compressed data decompresses into the original data, so that CompressedString
+    // can decompress it without validation (see TrustedDecode).
+    // \throw std::logic_error otherwise, which makes ctcs::compress() ill-formed.
+    template<class Decompressor, class CharT>
+    constexpr void verifyRoundTrip(std::string_view compressed_data, std::basic_string_view<CharT> data)
+    {
+      std::basic_string<CharT> decompressed_data(data.size(), CharT{});
+      const std::size_t size = Decompressor{}(compressed_data, std::span<CharT>(decompressed_data));
+      if (size != data.size() || decompressed_data != data)
+      {
+        CTCS_THROW(std::logic_error("ctcs::compress(): the compressed data doesn't match the input."));
+      }
+    }
+
+    // Encoder for CompileTimeOutput, which compresses the given string literal.
+    template<StringLiteral Str, class Compressor>
+    struct StringEncoder
+    {
+      template<std::size_t Capacity>
+      struct Output
+      {
+        CompileTimeBuffer<Capacity> data;
+      };
+
+      template<std::size_t Capacity>
+      static consteval Output<Capacity> run()
+      {
+        const std::string compressed_data = Compressor{}(Str.view());
+        verifyRoundTrip<typename Compressor::Decompressor>(compressed_data, Str.view());
+        return Output<Capacity>{ CompileTimeBuffer<Capacity>(compressed_data) };
+      }
+    };
+
+    // Encoder for CompileTimeOutput, which compresses the given array of bytes.
+    template<auto Data, class Compressor>
+    struct BytesEncoder
+    {
+      template<std::size_t Capacity>
+      struct Output
+      {
+        CompileTimeBuffer<Capacity> data;
+      };
+
+      template<std::size_t Capacity>
+      static consteval Output<Capacity> run()
+      {
+        std::string input(Data.size(), '\0');
+        for (std::size_t i = 0; i < Data.size(); ++i)
+        {
+          input[i] = static_cast<char>(Data[i]);
+        }
+        const std::string compressed_data = Compressor{}(input);
+        verifyRoundTrip<typename Compressor::Decompressor>(compressed_data, std::string_view(input));
+        return Output<Capacity>{ CompileTimeBuffer<Capacity>(compressed_data) };
+      }
+    };
+
+    // Runs the given encoder at compile time, and returns its output as a StringLiteral.
+    // Normally, the encoder only runs once.
+    template<class Encoder, std::size_t GuessedCapacity>
+    consteval auto encodeToLiteral()
+    {
+      constexpr const auto& kData = CompileTimeOutput<Encoder, GuessedCapacity>::kValue.data;
+      StringLiteral<kData.size> result;
+      for (std::size_t i = 0; i < kData.size; ++i)
+      {
+        result.data[i] = kData.data[i];
+      }
+      return result;
+    }
+  }
+
   // Compresses the given string literal.
+  //
+  // Literals of characters other than char (u8"", u"", U"", L"") are converted into UTF-8, which is
+  // then compressed with the given compressor; by default, ArithmeticCodingCompressor<Utf8Model<>>.
   // \param Str - input string.
   // \param Compressor - compressor to use.
-  template<StringLiteral Str, class Compressor = ArithmeticCodingCompressor<EnglishCharModel>>
+  // \param Observer - DecodeObserver for the returned CompressedString.
+  template<StringLiteral Str, class Compressor = Detail_NS::DefaultCompressor<typename decltype(Str)::char_type>,
+           DecodeObserver Observer = NoDecodeObserver>
+  consteval auto compress()
+  {
+    using CharT = typename decltype(Str)::char_type;
+    using ActualCompressor = Detail_NS::CompressorFor<CharT, Compressor>;
+    using Decompressor = typename ActualCompressor::Decompressor;
+    constexpr auto kCompressedData = Detail_NS::encodeToLiteral<Detail_NS::StringEncoder<Str, ActualCompressor>,
+                                                                Detail_NS::guessCompressedCapacity(Str.size() * sizeof(CharT))>();
+    return CompressedString<Decompressor, kCompressedData.size(), Str.size(), Observer>(kCompressedData);
+  }
+
+  // Compresses the given binary data.
+  //
+  // Usage:
+  //   constexpr std::array<unsigned char, 4> kTable = { 0, 1, 4, 9 };
+  //   constexpr auto kCompressed = ctcs::compress<kTable>();
+  //   const std::vector<unsigned char> table = kCompressed.decompress();
+  // \param Data - input data: std::array of std::byte or unsigned char.
+  // \param Compressor - compressor to use.
+  template<auto Data, class Compressor = BinaryCompressor<>>
+    requires ByteArray<decltype(Data)>
   consteval auto compress()
   {
     using Decompressor = typename Compressor::Decompressor;
-    constexpr std::size_t kCompressedDataSize = Compressor{}(Str.view()).size();
-    const std::string compressed_data = Compressor{}(Str.view());
-    StringLiteral<kCompressedDataSize> compressed_data_literal;
-    for (std::size_t i = 0; i < kCompressedDataSize; ++i)
+    constexpr auto kCompressedData = Detail_NS::encodeToLiteral<Detail_NS::BytesEncoder<Data, Compressor>,
+                                                                Detail_NS::guessCompressedCapacity(Data.size())>();
+    return CompressedBytes<Decompressor, kCompressedData.size(), Data.size(), typename decltype(Data)::value_type>(
+      kCompressedData);
+  }
+
+  namespace Detail_NS
+  {
+    // Static storage for the string returned by ctcs::lazy() and ctcs::prewarmed().
+    template<StringLiteral Str, class Compressor>
+    class LazyDecompressedString
     {
-      compressed_data_literal.data[i] = compressed_data[i];
-    }
-    return CompressedString<Decompressor, kCompressedDataSize>(compressed_data_literal);
+    public:
+      using CharT = typename decltype(Str)::char_type;
+
+      // Returns the decompressed string, decompressing it on the first call.
+      static std::basic_string_view<CharT> get()
+      {
+        // Fast path: the string has already been decompressed.
+        if (state_.load(std::memory_order_acquire) != kReady) [[unlikely]]
+        {
+          decompressOnce();
+        }
+        return std::basic_string_view<CharT>(data_.data(), data_.size());
+      }
+
+      // Registers the string for ctcs::prewarm().
+      // Odr-using this variable is enough: it is initialized before main() is entered.
+      static const bool kRegisteredForPrewarm;
+
+    private:
+      // The string hasn't been decompressed yet.
+      static constexpr unsigned char kEmpty = 0;
+      // Some thread is decompressing the string.
+      static constexpr unsigned char kBusy = 1;
+      // The string has been decompressed.
+      static constexpr unsigned char kReady = 2;
+
+      static constexpr auto kCompressed = compress<Str, Compressor>();
+
+      // Decompresses the string into data_, unless some other thread has already done it.
+      // Blocks if some other thread is decompressing the string right now.
+      // \return true if this call has decompressed the string, false otherwise.
+      static bool decompressOnce()
+      {
+        while (true)
+        {
+          unsigned char state = kEmpty;
+          if (state_.compare_exchange_strong(state, kBusy, std::memory_order_acquire))
+          {
+            CTCS_TRY
+            {
+              kCompressed.decompressInto(data_);
+            }
+            CTCS_CATCH(...)
+            {
+              // Let some other call try again.
+              state_.store(kEmpty, std::memory_order_release);
+              state_.notify_all();
+              CTCS_RETHROW;
+            }
+            state_.store(kReady, std::memory_order_release);
+            state_.notify_all();
+            return true;
+          }
+          if (state == kReady)
+          {
+            return false;
+          }
+          state_.wait(kBusy, std::memory_order_acquire);
+        }
+      }
+
+      static inline std::array<CharT, Str.size()> data_{};
+      static inline std::atomic<unsigned char> state_{ kEmpty };
+      static inline PrewarmEntry prewarm_entry_{ &decompressOnce, Str.size() * sizeof(CharT), nullptr };
+    };
+
+    template<StringLiteral Str, class Compressor>
+    const bool LazyDecompressedString<Str, Compressor>::kRegisteredForPrewarm = PrewarmRegistry::add(prewarm_entry_);
+  }
+
+  // Returns the decompressed string literal.
+  //
+  // The string is decompressed into static storage on the first call; subsequent calls only
+  // perform a single atomic load. The function is thread-safe: if several threads call it
+  // concurrently before the string is decompressed, only one of them decompresses it, and
+  // the others wait.
+  // \param Str - input string.
+  // \param Compressor - compressor to use.
+  // \return a view of the decompressed string, valid until the end of the program.
+  template<StringLiteral Str, class Compressor = Detail_NS::DefaultCompressor<typename decltype(Str)::char_type>>
+  std::basic_string_view<typename decltype(Str)::char_type> lazy()
+  {
+    return Detail_NS::LazyDecompressedString<Str, Compressor>::get();
+  }
+
+  // Same as ctcs::lazy(), but also registers the string for ctcs::prewarm().
+  //
+  // The string is registered during static initialization if this function is instantiated anywhere
+  // in the program, even if it is never called. Thus, ctcs::prewarm() called at startup decompresses
+  // the string ahead of time, and the first call to this function only performs an atomic load.
+  // \param Str - input string.
+  // \param Compressor - compressor to use.
+  // \return a view of the decompressed string, valid until the end of the program.
+  template<StringLiteral Str, class Compressor = Detail_NS::DefaultCompressor<typename decltype(Str)::char_type>>
+  std::basic_string_view<typename decltype(Str)::char_type> prewarmed()
+  {
+    using LazyString = Detail_NS::LazyDecompressedString<Str, Compressor>;
+    static_cast<void>(LazyString::kRegisteredForPrewarm);
+    return LazyString::get();
   }
 }
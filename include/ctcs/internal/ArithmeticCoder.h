@@ -2,9 +2,14 @@
 
 #include "ArithmeticCoding.h"
 #include "ArithmeticCodingCommon.h"
+#include "Exceptions.h"
 #include "OBitStream.h"
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
 
 namespace ctcs::ArithmeticCoding_NS
@@ -41,9 +46,19 @@ public:
 private:
   constexpr void pushBit(bool bit);
 
+  // Outputs the given bits, starting from the most significant one. The first bit is followed by
+  // bits_to_follow_ opposite bits, as in pushBit().
+  // \param bits - bits to output; only the lowest num_bits bits may be set.
+  // \param num_bits - the number of bits to output, 1 <= num_bits <= kCodeValueBits.
+  //        kCodeValueBits never exceeds OBitStream::kMaxBitsPerPut.
+  constexpr void pushBits(CodeValue bits, unsigned int num_bits);
+
   static constexpr ArithmeticCodingTraits::CodeValue kFirstQuarter = ArithmeticCodingTraits::kFirstQuarter;
   static constexpr ArithmeticCodingTraits::CodeValue kHalf = ArithmeticCodingTraits::kHalf;
   static constexpr ArithmeticCodingTraits::CodeValue kThirdQuarter = ArithmeticCodingTraits::kThirdQuarter;
+  static constexpr unsigned int kCodeValueBits = ArithmeticCodingTraits::kCodeValueBits;
+  // The number of the most significant bits of CodeValue that are not used by code values.
+  static constexpr unsigned int kNumUnusedBits = std::numeric_limits<CodeValue>::digits - kCodeValueBits;
 
   // The output stream for encoded data.
   OBitStream* bit_stream_ = nullptr;
@@ -61,11 +76,11 @@ constexpr ArithmeticCoder::ArithmeticCoder(OBitStream& output_stream):
 
 constexpr ArithmeticCoder::~ArithmeticCoder()
 {
-  try
+  CTCS_TRY
   {
     finalize();
   }
-  catch (...)
+  CTCS_CATCH(...)
   {
   }
 }
@@ -77,34 +92,34 @@ constexpr void ArithmeticCoder::encode(std::pair<FrequencyCount, FrequencyCount>
   assert(range.second <= denominator);
 
   // Determine the new subinterval.
-  std::tie(lower_bound_, upper_bound_) =
+  // The bounds are kept in local variables during renormalization, which is noticeably cheaper
+  // during constant evaluation.
+  const CodeInterval subinterval =
     getSubInterval(lower_bound_, upper_bound_, range.first, range.second, denominator);
-  // Perform renormalization, if needed.
-  while (true)
+  CodeValue lower_bound = subinterval.lower;
+  CodeValue upper_bound = subinterval.upper;
+  // Perform renormalization, if needed. Both steps are done at once rather than bit by bit, which
+  // is what makes the difference during constant evaluation.
+  // The leading bits that are equal in both bounds will not change anymore: shift them out.
+  const unsigned int num_equal_bits =
+    static_cast<unsigned int>(std::countl_zero(lower_bound ^ upper_bound)) - kNumUnusedBits;
+  if (num_equal_bits != 0)
   {
-    if (upper_bound_ < kHalf)
-    {
-      pushBit(0);
-    }
-    else if (lower_bound_ >= kHalf)
-    {
-      pushBit(1);
-      lower_bound_ -= kHalf;
-      upper_bound_ -= kHalf;
-    }
-    else if (kFirstQuarter <= lower_bound_ && upper_bound_ < kThirdQuarter)
-    {
-      bits_to_follow_++;
-      lower_bound_ -= kFirstQuarter;
-      upper_bound_ -= kFirstQuarter;
-    }
-    else
-    {
-      break;
-    }
-    lower_bound_ = lower_bound_ * 2;
-    upper_bound_ = upper_bound_ * 2 + 1;
+    pushBits(lower_bound >> (kCodeValueBits - num_equal_bits), num_equal_bits);
+    const CodeValue low_bits_mask = (static_cast<CodeValue>(1) << num_equal_bits) - 1;
+    lower_bound = (lower_bound << num_equal_bits) & ArithmeticCodingTraits::kTopValue;
+    upper_bound = ((upper_bound << num_equal_bits) | low_bits_mask) & ArithmeticCodingTraits::kTopValue;
   }
+  // Now lower_bound < kHalf <= upper_bound. While kFirstQuarter <= lower_bound && upper_bound < kThirdQuarter,
+  // i.e. the second bit is 1 in lower_bound and 0 in upper_bound, remove the second bit from both bounds.
+  const unsigned int num_underflow_bits =
+    static_cast<unsigned int>(std::countl_zero(~((lower_bound & ~upper_bound) << (kNumUnusedBits + 1))));
+  bits_to_follow_ += num_underflow_bits;
+  lower_bound = (lower_bound << num_underflow_bits) & (kHalf - 1);
+  upper_bound = kHalf | ((upper_bound << num_underflow_bits) & (kHalf - 1)) |
+                ((static_cast<CodeValue>(1) << num_underflow_bits) - 1);
+  lower_bound_ = lower_bound;
+  upper_bound_ = upper_bound;
 }
 
 constexpr void ArithmeticCoder::finalize()
@@ -123,16 +138,42 @@ constexpr void ArithmeticCoder::finalize()
 }
 
 constexpr void ArithmeticCoder::pushBit(bool bit)
+{
+  pushBits(static_cast<CodeValue>(bit), 1);
+}
+
+constexpr void ArithmeticCoder::pushBits(CodeValue bits, unsigned int num_bits)
 {
   if (!bit_stream_)
   {
-    throw std::runtime_error("ArithmeticCoder::pushBit(): finalize() has already been called.");
+    CTCS_THROW(std::runtime_error("ArithmeticCoder::pushBits(): finalize() has already been called."));
+  }
+  static_assert(kCodeValueBits <= OBitStream::kMaxBitsPerPut);
+  const unsigned int num_bits_total = num_bits + bits_to_follow_;
+  if (num_bits_total <= OBitStream::kMaxBitsPerPut)
+  {
+    // Usually, the first bit, the opposite bits and the remaining bits fit into a single put(), which is
+    // much cheaper during constant evaluation: adding 2^(num_bits_total - 1) - 2^(num_bits - 1)
+    // to the bits inserts bits_to_follow_ opposite bits after the first one.
+    const CodeValue opposite_bits = ((CodeValue{ 1 } << num_bits_total) - (CodeValue{ 1 } << num_bits)) >> 1;
+    bit_stream_->put(static_cast<std::uint32_t>(bits + opposite_bits), num_bits_total);
+    bits_to_follow_ = 0;
+    return;
   }
-  bit_stream_->put(bit);
-  for (; bits_to_follow_ > 0; --bits_to_follow_)
+  const bool first_bit = ((bits >> (num_bits - 1)) & 1) != 0;
+  bit_stream_->put(first_bit);
+  // Output the opposite bits.
+  constexpr unsigned int kMaxBitsPerPut = OBitStream::kMaxBitsPerPut;
+  const std::uint32_t opposite_bits = first_bit ? 0 : ~std::uint32_t{ 0 };
+  while (bits_to_follow_ > 0)
   {
-    bit_stream_->put(!bit);
+    const unsigned int num_opposite_bits = std::min(bits_to_follow_, kMaxBitsPerPut);
+    bit_stream_->put(opposite_bits >> (kMaxBitsPerPut - num_opposite_bits), num_opposite_bits);
+    bits_to_follow_ -= num_opposite_bits;
   }
+  // Output the remaining bits.
+  const CodeValue remaining_bits_mask = (static_cast<CodeValue>(1) << (num_bits - 1)) - 1;
+  bit_stream_->put(static_cast<std::uint32_t>(bits & remaining_bits_mask), num_bits - 1);
 }
 
 template<ArithmeticCodingModel Model>
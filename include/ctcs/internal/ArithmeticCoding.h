@@ -5,6 +5,7 @@
 #include <concepts>
 #include <cstdint>
 #include <limits>
+#include <type_traits>
 #include <utility>
 
 namespace ctcs::ArithmeticCoding_NS
@@ -67,4 +68,89 @@ concept ArithmeticCodingModel = requires(const T& model)
   // Note that scalingFactor(), getCharByPoint(), getInterval() can be static member functions.
 };
 
+// Defines a named requirement for an adaptive arithmetic coding model, i.e. a model
+// that changes after each symbol. The changes must be the same during encoding and decoding,
+// so both ArithmeticCoder's and ArithmeticDecoder's users must call update() after every symbol.
+template<typename T>
+concept AdaptiveArithmeticCodingModel = ArithmeticCodingModel<T> && requires(T& model)
+{
+  // If 'model' is a non-const reference to T,
+  // then model.update() must be callable with a parameter of the type T::char_type.
+  model.update(std::declval<const typename T::char_type&>());
+};
+
+// A symbol together with its interval [lower, upper).
+template<class CharT>
+struct DecodedSymbol
+{
+  CharT symbol;
+  std::pair<ArithmeticCodingTraits::FrequencyCount, ArithmeticCodingTraits::FrequencyCount> interval;
+};
+
+// Defines a named requirement for an arithmetic coding model, which can find the symbol
+// by a point and return it together with its interval in a single call.
+template<typename T>
+concept FusedArithmeticCodingModel = ArithmeticCodingModel<T> && requires(const T& model)
+{
+  // If 'model' is a const-qualified reference to T,
+  // then calling model.decodeSymbol() with a parameter of the type FrequencyCount
+  // must return DecodedSymbol<T::char_type>.
+  {model.decodeSymbol(std::declval<const ArithmeticCodingTraits::FrequencyCount&>())}
+    -> std::same_as<DecodedSymbol<typename T::char_type>>;
+};
+
+// Defines a named requirement for an arithmetic coding model, which can decode a symbol without
+// validating the point, if the given DecodePolicy allows it (see ctcs::TrustedDecode).
+template<typename T, typename Policy>
+concept PolicyAwareArithmeticCodingModel = ArithmeticCodingModel<T> && requires(const T& model, Policy policy)
+{
+  // If 'model' is a const-qualified reference to T,
+  // then calling model.decodeSymbol() with parameters of the types FrequencyCount and Policy
+  // must return DecodedSymbol<T::char_type>.
+  {model.decodeSymbol(std::declval<const ArithmeticCodingTraits::FrequencyCount&>(), policy)}
+    -> std::same_as<DecodedSymbol<typename T::char_type>>;
+};
+
+// Find the symbol whose interval [lower, upper) contains the specified point.
+// Uses model.decodeSymbol() if the model provides it, otherwise calls
+// model.getCharByPoint() and model.getInterval().
+// \param model - arithmetic coding model.
+// \param point - input point.
+// \return the symbol and its interval.
+template<ArithmeticCodingModel Model>
+constexpr DecodedSymbol<typename Model::char_type> decodeSymbol(const Model& model,
+                                                                ArithmeticCodingTraits::FrequencyCount point)
+{
+  if constexpr (FusedArithmeticCodingModel<Model>)
+  {
+    return model.decodeSymbol(point);
+  }
+  else
+  {
+    const typename Model::char_type symbol = model.getCharByPoint(point);
+    return { symbol, model.getInterval(symbol) };
+  }
+}
+
+// Same as above, but passes the given DecodePolicy to the model if it accepts one,
+// so that the model can skip the validation of the point with ctcs::TrustedDecode.
+// \param model - arithmetic coding model.
+// \param point - input point.
+// \param policy - ctcs::CheckedDecode or ctcs::TrustedDecode.
+// \return the symbol and its interval.
+template<ArithmeticCodingModel Model, class Policy>
+constexpr DecodedSymbol<typename Model::char_type> decodeSymbol(const Model& model,
+                                                                ArithmeticCodingTraits::FrequencyCount point,
+                                                                Policy policy)
+{
+  if constexpr (PolicyAwareArithmeticCodingModel<Model, Policy>)
+  {
+    return model.decodeSymbol(point, policy);
+  }
+  else
+  {
+    return decodeSymbol(model, point);
+  }
+}
+
 }
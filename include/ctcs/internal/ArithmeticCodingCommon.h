@@ -2,11 +2,17 @@
 
 #include "ArithmeticCoding.h"
 
-#include <utility>
-
 namespace ctcs::ArithmeticCoding_NS
 {
 
+// Closed interval [lower; upper] of code values.
+// A plain struct rather than std::pair, which is much more expensive to construct during constant evaluation.
+struct CodeInterval
+{
+  ArithmeticCodingTraits::CodeValue lower;
+  ArithmeticCodingTraits::CodeValue upper;
+};
+
 // Maps the given subinterval of [0; 1) into the specified interval [a; b).
 // \param [lower_bound; upper_bound) - the input interval [a; b).
 // \param [lower_bound_for_char/scaling_factor; upper_bound_for_char/scaling_factor) -
@@ -14,8 +20,7 @@ namespace ctcs::ArithmeticCoding_NS
 // Expects that:
 //   0 <= lower_bound < upper_bound <= ArithmeticCodingTraits::kTopValue.
 //   0 <= lower_bound_for_char < upper_bound_for_char <= scaling_factor.
-constexpr
-std::pair<ArithmeticCodingTraits::CodeValue, ArithmeticCodingTraits::CodeValue>
+constexpr CodeInterval
 getSubInterval(ArithmeticCodingTraits::CodeValue lower_bound,
                ArithmeticCodingTraits::CodeValue upper_bound,
                ArithmeticCodingTraits::FrequencyCount lower_bound_for_char,
@@ -2,21 +2,29 @@
 
 #include "ArithmeticCoding.h"
 #include "ArithmeticCodingCommon.h"
+#include "Exceptions.h"
 #include "IBitStream.h"
 
+#include <bit>
+#include <limits>
 #include <stdexcept>
 #include <utility>
 
 namespace ctcs::ArithmeticCoding_NS
 {
 
-class ArithmeticDecoder
+// Decoder for the data encoded via ArithmeticCoder.
+// \param Policy - ctcs::CheckedDecode or ctcs::TrustedDecode. With CheckedDecode, the decoder throws
+//        std::logic_error if the data ends too early. With TrustedDecode, it skips this check, and
+//        lets the model skip the validation of the decoded point, if the model supports that.
+template<class Policy>
+class BasicArithmeticDecoder
 {
 public:
   using CodeValue = ArithmeticCodingTraits::CodeValue;
   using FrequencyCount = ArithmeticCodingTraits::FrequencyCount;
 
-  explicit constexpr ArithmeticDecoder(IBitStream& input_stream);
+  explicit constexpr BasicArithmeticDecoder(IBitStream& input_stream);
 
   template<ArithmeticCodingModel Model>
   constexpr typename Model::char_type decode(const Model& model);
@@ -26,12 +34,14 @@ private:
 
   constexpr void normalize();
 
-  constexpr bool readBit();
+  // Reads the specified number of bits from the stream.
+  // \param num_bits - the number of bits to read. Must not exceed IBitStream::kMaxBitsPerRead.
+  constexpr CodeValue readBits(unsigned int num_bits);
 
   IBitStream& bit_stream_;
   // If the stream gets empty, we can still pretend that a few 0s are available.
   // However, we want to ensure that at least the highest 2 bits of the code value
-  // are meaningful, so we track the number of such "garbage" bits.
+  // are meaningful, so we track the number of such "garbage" bits (only if Policy::kChecked is true).
   std::size_t num_garbage_bits_ = 0;
   // Currently-seen code value.
   CodeValue value_ = 0;
@@ -40,86 +50,82 @@ private:
   CodeValue upper_bound_ = ArithmeticCodingTraits::kTopValue;
 };
 
-constexpr ArithmeticDecoder::ArithmeticDecoder(IBitStream& input_stream) :
+template<class Policy>
+constexpr BasicArithmeticDecoder<Policy>::BasicArithmeticDecoder(IBitStream& input_stream) :
   bit_stream_(input_stream)
 {
   // Read the first bits to fill the code value.
-  for (unsigned int i = 0; i < ArithmeticCodingTraits::kCodeValueBits; ++i)
-  {
-    value_ <<= 1;
-    value_ |= static_cast<CodeValue>(readBit());
-  }
+  value_ = readBits(ArithmeticCodingTraits::kCodeValueBits);
 }
 
+template<class Policy>
 template<ArithmeticCodingModel Model>
-constexpr typename Model::char_type ArithmeticDecoder::decode(const Model& model)
+constexpr typename Model::char_type BasicArithmeticDecoder<Policy>::decode(const Model& model)
 {
   normalize();
   const CodeValue range = upper_bound_ - lower_bound_ + 1;
   const FrequencyCount scaling_factor = model.scalingFactor();
   const FrequencyCount cumulative_freq =
     static_cast<FrequencyCount>(((value_ - lower_bound_ + 1) * scaling_factor - 1) / range);
-  // TODO: consider merging this into a single call.
-  const Model::char_type symbol = model.getCharByPoint(cumulative_freq);
-  const std::pair<FrequencyCount, FrequencyCount> interval = model.getInterval(symbol);
-  decodeImpl(interval, scaling_factor);
-  return symbol;
+  const DecodedSymbol<typename Model::char_type> decoded = decodeSymbol(model, cumulative_freq, Policy{});
+  decodeImpl(decoded.interval, scaling_factor);
+  return decoded.symbol;
 }
 
-constexpr void ArithmeticDecoder::decodeImpl(std::pair<FrequencyCount, FrequencyCount> range, FrequencyCount denominator)
+template<class Policy>
+constexpr void BasicArithmeticDecoder<Policy>::decodeImpl(std::pair<FrequencyCount, FrequencyCount> range, FrequencyCount denominator)
 {
   // Narrow the code region to that alloted to this symbol.
-  std::tie(lower_bound_, upper_bound_) =
+  const CodeInterval subinterval =
     getSubInterval(lower_bound_, upper_bound_, range.first, range.second, denominator);
+  lower_bound_ = subinterval.lower;
+  upper_bound_ = subinterval.upper;
 }
 
-constexpr void ArithmeticDecoder::normalize()
+template<class Policy>
+constexpr void BasicArithmeticDecoder<Policy>::normalize()
 {
-  // Loop to get rid of bits.
-  while (true)
+  // Renormalization shifts out the leading bits that are equal in both bounds, and then the underflow
+  // bits (the second bit is 1 in lower_bound_ and 0 in upper_bound_), just like ArithmeticCoder::encode().
+  // Every bit transforms the offset of the code value from the left endpoint of the code region
+  // as offset * 2 + next_bit, so all the bits are read at once.
+  constexpr unsigned int kNumUnusedBits = std::numeric_limits<CodeValue>::digits - ArithmeticCodingTraits::kCodeValueBits;
+  const CodeValue offset = value_ - lower_bound_;
+  const unsigned int num_equal_bits =
+    static_cast<unsigned int>(std::countl_zero(lower_bound_ ^ upper_bound_)) - kNumUnusedBits;
+  lower_bound_ = (lower_bound_ << num_equal_bits) & ArithmeticCodingTraits::kTopValue;
+  upper_bound_ = ((upper_bound_ << num_equal_bits) | ((CodeValue{ 1 } << num_equal_bits) - 1)) &
+                 ArithmeticCodingTraits::kTopValue;
+  const unsigned int num_underflow_bits =
+    static_cast<unsigned int>(std::countl_zero(~((lower_bound_ & ~upper_bound_) << (kNumUnusedBits + 1))));
+  lower_bound_ = (lower_bound_ << num_underflow_bits) & (ArithmeticCodingTraits::kHalf - 1);
+  upper_bound_ = ArithmeticCodingTraits::kHalf | ((upper_bound_ << num_underflow_bits) & (ArithmeticCodingTraits::kHalf - 1)) |
+                 ((CodeValue{ 1 } << num_underflow_bits) - 1);
+  const unsigned int num_bits = num_equal_bits + num_underflow_bits;
+  if (num_bits != 0)
   {
-    if (upper_bound_ < ArithmeticCodingTraits::kHalf)
-    {
-      // nothing
-    }
-    else if (lower_bound_ >= ArithmeticCodingTraits::kHalf)
-    {
-      value_ -= ArithmeticCodingTraits::kHalf;
-      lower_bound_ -= ArithmeticCodingTraits::kHalf;
-      upper_bound_ -= ArithmeticCodingTraits::kHalf;
-    }
-    else if (lower_bound_ >= ArithmeticCodingTraits::kFirstQuarter &&
-             upper_bound_ < ArithmeticCodingTraits::kThirdQuarter)
-    {
-      value_ -= ArithmeticCodingTraits::kFirstQuarter;
-      lower_bound_ -= ArithmeticCodingTraits::kFirstQuarter;
-      upper_bound_ -= ArithmeticCodingTraits::kFirstQuarter;
-    }
-    else
-    {
-      break;
-    }
-    lower_bound_ = 2 * lower_bound_;
-    upper_bound_ = 2 * upper_bound_ + 1;
-    value_ = 2 * value_ + static_cast<CodeValue>(readBit());
+    value_ = lower_bound_ + ((offset << num_bits) | readBits(num_bits));
   }
 }
 
-constexpr bool ArithmeticDecoder::readBit()
+template<class Policy>
+constexpr typename BasicArithmeticDecoder<Policy>::CodeValue BasicArithmeticDecoder<Policy>::readBits(unsigned int num_bits)
 {
+  static_assert(ArithmeticCodingTraits::kCodeValueBits <= IBitStream::kMaxBitsPerRead,
+    "IBitStream must be able to read a code value at once.");
   constexpr std::size_t kMaxGarbageBits = ArithmeticCodingTraits::kCodeValueBits - 2;
-  if (std::optional<bool> bit = bit_stream_.get())
-  {
-    return *bit;
-  }
+  const ReadBitsResult bits = bit_stream_.get(num_bits);
   // ArithmeticCoder ensures that the output number of bits is sufficient for decoding
   // all characters from the input text. It is the responsibility of the user to know
   // when to stop calling decode() by tracking the number of characters decoded.
-  ++num_garbage_bits_;
-  if (num_garbage_bits_ > kMaxGarbageBits) {
-    throw std::logic_error("ArithmeticDecoder: unexpected end of stream.");
+  if constexpr (Policy::kChecked)
+  {
+    num_garbage_bits_ += num_bits - bits.num_bits_read;
+    if (num_garbage_bits_ > kMaxGarbageBits) {
+      CTCS_THROW(std::logic_error("ArithmeticDecoder: unexpected end of stream."));
+    }
   }
-  return false;
+  return static_cast<CodeValue>(bits.value);
 }
 
 }
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "ArithmeticCodingCommon.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Runtime counterpart of ArithmeticCoder, which produces exactly the same bits.
+//
+// ArithmeticCoder is tuned for constant evaluation; this class is tuned for the CPU:
+// * The bits are accumulated in a register, which is written into a preallocated buffer after every
+//   symbol without any branches, and without any calls to std::string member functions except for
+//   occasional growth.
+// * Renormalization takes constant time and has no branches: the number of steps ArithmeticCoder
+//   would perform is computed from the length of the interval, and the bounds are shifted at once.
+// * encode() processes the whole string with the state of the coder in local variables: since the
+//   output is written via char*, the compiler would otherwise reload the members after every write.
+class BufferedArithmeticCoder
+{
+public:
+  using CodeValue = ArithmeticCodingTraits::CodeValue;
+  using FrequencyCount = ArithmeticCodingTraits::FrequencyCount;
+
+  // Starts appending the encoded data to the given string.
+  // \param dest - output string.
+  // \param expected_size - the expected size of the encoded data in bytes. The buffer grows
+  //        automatically if the estimate is too low.
+  BufferedArithmeticCoder(std::string& dest, std::size_t expected_size);
+
+  // Non-copyable, non-movable.
+  BufferedArithmeticCoder(const BufferedArithmeticCoder&) = delete;
+  BufferedArithmeticCoder(BufferedArithmeticCoder&& other) = delete;
+  BufferedArithmeticCoder& operator=(const BufferedArithmeticCoder&) = delete;
+  BufferedArithmeticCoder& operator=(BufferedArithmeticCoder&& other) = delete;
+
+  // Encodes the given symbols. If the model is adaptive, it is updated after every symbol.
+  template<ArithmeticCodingModel Model>
+  void encode(Model& model, std::basic_string_view<typename Model::char_type> symbols);
+
+  // Writes the remaining bits, padding the last byte with zeros, and trims the string to the encoded data.
+  // No other member functions may be called after this one.
+  void finalize();
+
+private:
+  static constexpr CodeValue kFirstQuarter = ArithmeticCodingTraits::kFirstQuarter;
+  static constexpr CodeValue kTopValue = ArithmeticCodingTraits::kTopValue;
+  static constexpr unsigned int kCodeValueBits = ArithmeticCodingTraits::kCodeValueBits;
+  // The number of the least significant bits of CodeValue that are not used by code values.
+  // encode() keeps the code values in the most significant bits instead.
+  static constexpr unsigned int kNumUnusedBits = std::numeric_limits<CodeValue>::digits - kCodeValueBits;
+  // The maximum number of bits that can be written via a single call to State::putBits().
+  static constexpr unsigned int kMaxBitsPerPut = 32;
+  // The number of bytes that must be available in the buffer before encoding a symbol,
+  // not counting the bits to follow: State::putBits() always writes 8 bytes.
+  static constexpr std::size_t kMaxBytesPerSymbol = 2 * kMaxBitsPerPut / 8 + sizeof(std::uint64_t);
+
+  static_assert(kCodeValueBits <= kMaxBitsPerPut);
+  static_assert(kCodeValueBits <= kNumUnusedBits, "encode() needs room for kCodeValueBits shifted-in bits.");
+
+  // The state of the coder.
+  struct State
+  {
+    // Appends the lowest num_bits_to_put bits of the given value, starting from the most significant one.
+    // Writes all bits accumulated so far into the next 8 bytes of the buffer, and advances the
+    // output pointer past the complete bytes, so that there are no branches.
+    void putBits(std::uint64_t bits, unsigned int num_bits_to_put)
+    {
+      assert(num_bits_to_put <= kMaxBitsPerPut);
+      num_bits += num_bits_to_put;
+      current_bits |= (bits << 1) << (63 - num_bits);
+      out[0] = static_cast<char>(current_bits >> 56);
+      out[1] = static_cast<char>(current_bits >> 48);
+      out[2] = static_cast<char>(current_bits >> 40);
+      out[3] = static_cast<char>(current_bits >> 32);
+      out[4] = static_cast<char>(current_bits >> 24);
+      out[5] = static_cast<char>(current_bits >> 16);
+      out[6] = static_cast<char>(current_bits >> 8);
+      out[7] = static_cast<char>(current_bits);
+      out += num_bits / 8;
+      current_bits <<= num_bits & ~7u;
+      num_bits %= 8;
+    }
+
+    // \return the maximum number of bytes that encoding the next symbol can write.
+    std::size_t maxBytesPerSymbol() const noexcept
+    {
+      return kMaxBytesPerSymbol + bits_to_follow / 8;
+    }
+
+    // The next byte to write, and the end of the buffer.
+    char* out;
+    char* end;
+    // Left and right endpoints of the interval representing the current state.
+    CodeValue lower_bound;
+    CodeValue upper_bound;
+    // The number of opposite bits to output after the next bit.
+    unsigned int bits_to_follow;
+    // The bits of the incomplete byte, starting from the most significant bit; the rest are zeros.
+    std::uint64_t current_bits;
+    // The number of bits in current_bits. Always less than 8 between the calls to putBits().
+    unsigned int num_bits;
+  };
+
+  // Ensures that the buffer has at least state.maxBytesPerSymbol() free bytes.
+  // \return the updated state.
+  State reserve(State state);
+
+  // Outputs the given bits, starting from the most significant one. The first bit is followed by
+  // state.bits_to_follow opposite bits, like in ArithmeticCoder::pushBits().
+  // encode() handles the common case (a few bits to follow) itself; the state is passed by value
+  // so that it can stay in registers there.
+  // \param bits - bits to output; only the lowest num_bits bits may be set.
+  // \param num_bits - the number of bits to output, 1 <= num_bits <= kCodeValueBits.
+  // \return the updated state.
+  static State pushBits(State state, CodeValue bits, unsigned int num_bits);
+
+  std::string& dest_;
+  State state_;
+};
+
+inline BufferedArithmeticCoder::BufferedArithmeticCoder(std::string& dest, std::size_t expected_size):
+  dest_(dest)
+{
+  const std::size_t offset = dest_.size();
+  dest_.resize(offset + expected_size + kMaxBytesPerSymbol);
+  state_ = State{
+    .out = dest_.data() + offset,
+    .end = dest_.data() + dest_.size(),
+    .lower_bound = 0,
+    .upper_bound = kTopValue,
+    .bits_to_follow = 0,
+    .current_bits = 0,
+    .num_bits = 0
+  };
+}
+
+template<ArithmeticCodingModel Model>
+void BufferedArithmeticCoder::encode(Model& model, std::basic_string_view<typename Model::char_type> symbols)
+{
+  constexpr CodeValue kTopBit = CodeValue{ 1 } << (std::numeric_limits<CodeValue>::digits - 1);
+  State state = state_;
+  // The lower bound, shifted into the most significant bits, and the length of the interval.
+  // The loop only depends on them, and never computes the upper bound.
+  CodeValue lower_bound = state.lower_bound << kNumUnusedBits;
+  CodeValue length = state.upper_bound - state.lower_bound + 1;
+  for (const typename Model::char_type symbol : symbols)
+  {
+    if (static_cast<std::size_t>(state.end - state.out) < state.maxBytesPerSymbol()) [[unlikely]]
+    {
+      state = reserve(state);
+    }
+    const std::pair<FrequencyCount, FrequencyCount> range = model.getInterval(symbol);
+    const FrequencyCount denominator = model.scalingFactor();
+    assert(denominator != 0);
+    assert(range.first < range.second);
+    assert(range.second <= denominator);
+    // Same as getSubInterval(), with the upper bound followed by ones instead of zeros.
+    const CodeValue lower_offset = range.first * length / denominator;
+    const CodeValue upper_offset = range.second * length / denominator;
+    const CodeValue sub_lower_bound = lower_bound + (lower_offset << kNumUnusedBits);
+    const CodeValue sub_upper_bound = lower_bound + (upper_offset << kNumUnusedBits) - 1;
+    const CodeValue sub_length = upper_offset - lower_offset;
+    // ArithmeticCoder stops renormalizing once the interval contains kHalf, and either kFirstQuarter
+    // or kThirdQuarter, so it ends up longer than a quarter, but no longer than a half before the
+    // last step. Thus, the number of steps is either max_steps or max_steps - 1, where
+    // max_steps = kCodeValueBits - 1 - ceil(log2(sub_length)) + 1; it is never negative.
+    const unsigned int max_steps = static_cast<unsigned int>(std::countl_zero((sub_length << 1) - 1)) -
+                                   (kNumUnusedBits - 1);
+    // The bounds after max_steps - 1 steps, with an extra zero in front, in case max_steps is 0
+    // (then the leading bits are equal, and the last step is performed, which is right).
+    // Every step shifts both bounds; an underflow step also flips their leading bits, which
+    // doesn't affect the check of the next step below.
+    const CodeValue lower_bound_before_last = (sub_lower_bound >> 1) << max_steps;
+    const CodeValue upper_bound_before_last = (sub_upper_bound >> 1) << max_steps;
+    // The last step is performed if the leading bits are equal, or if the second bits are 1 in the
+    // lower bound and 0 in the upper one (i.e. the interval is within [kFirstQuarter; kThirdQuarter)).
+    const unsigned int last_step = static_cast<unsigned int>(
+      (~(lower_bound_before_last ^ upper_bound_before_last) |
+       ((lower_bound_before_last & ~upper_bound_before_last) << 1)) >> (std::numeric_limits<CodeValue>::digits - 1));
+    const unsigned int num_steps = max_steps - 1 + last_step;
+    // The leading bit of the lower bound is 0 after renormalization.
+    lower_bound = (lower_bound_before_last << last_step) & ~kTopBit;
+    length = (sub_length << max_steps) >> (1 - last_step);
+    // The first num_equal_bits steps output the bits that are equal in both bounds, the other
+    // ones are underflow steps. The bounds differ in the unused bits, so num_equal_bits <= kCodeValueBits.
+    const unsigned int num_equal_bits =
+      static_cast<unsigned int>(std::countl_zero((sub_lower_bound ^ sub_upper_bound) | 1));
+    const CodeValue bits = (sub_lower_bound >> 1) >> (std::numeric_limits<CodeValue>::digits - 1 - num_equal_bits);
+    // The first bit, the opposite bits to follow, and the remaining bits: adding
+    // 2^(num_bits_total - 1) - 2^(num_equal_bits - 1) to the bits inserts the opposite bits
+    // after the first one. Nothing is written if there are no equal bits.
+    const unsigned int num_bits_total = (num_equal_bits != 0) ? (state.bits_to_follow + num_equal_bits) : 0;
+    if (num_bits_total <= kMaxBitsPerPut) [[likely]]
+    {
+      state.putBits(bits + (((CodeValue{ 1 } << num_bits_total) - (CodeValue{ 1 } << num_equal_bits)) >> 1),
+                    num_bits_total);
+      state.bits_to_follow = (num_equal_bits != 0) ? 0 : state.bits_to_follow;
+    }
+    else
+    {
+      state = pushBits(state, bits, num_equal_bits);
+    }
+    state.bits_to_follow += num_steps - num_equal_bits;
+    if constexpr (AdaptiveArithmeticCodingModel<Model>)
+    {
+      model.update(symbol);
+    }
+  }
+  state.lower_bound = lower_bound >> kNumUnusedBits;
+  state.upper_bound = state.lower_bound + length - 1;
+  state_ = state;
+}
+
+inline void BufferedArithmeticCoder::finalize()
+{
+  State state = reserve(state_);
+  // Push 2 bits that select the quarter that the current code range contains.
+  state.bits_to_follow += 1;
+  state = pushBits(state, (state.lower_bound < kFirstQuarter) ? 0 : 1, 1);
+  // putBits() has already written the last byte, padded with zeros.
+  if (state.num_bits != 0)
+  {
+    ++state.out;
+  }
+  dest_.resize(static_cast<std::size_t>(state.out - dest_.data()));
+}
+
+inline BufferedArithmeticCoder::State BufferedArithmeticCoder::reserve(State state)
+{
+  const std::size_t offset = static_cast<std::size_t>(state.out - dest_.data());
+  const std::size_t min_size = offset + state.maxBytesPerSymbol();
+  if (dest_.size() < min_size)
+  {
+    dest_.resize(std::max(dest_.size() * 2, min_size));
+  }
+  state.out = dest_.data() + offset;
+  state.end = dest_.data() + dest_.size();
+  return state;
+}
+
+inline BufferedArithmeticCoder::State BufferedArithmeticCoder::pushBits(State state, CodeValue bits,
+                                                                         unsigned int num_bits)
+{
+  const bool first_bit = ((bits >> (num_bits - 1)) & 1) != 0;
+  state.putBits(first_bit, 1);
+  const std::uint64_t opposite_bits = first_bit ? 0 : ~std::uint64_t{ 0 };
+  while (state.bits_to_follow > 0)
+  {
+    const unsigned int num_opposite_bits = std::min(state.bits_to_follow, kMaxBitsPerPut);
+    state.putBits(opposite_bits >> (std::numeric_limits<std::uint64_t>::digits - num_opposite_bits),
+                  num_opposite_bits);
+    state.bits_to_follow -= num_opposite_bits;
+  }
+  state.putBits(bits & ((CodeValue{ 1 } << (num_bits - 1)) - 1), num_bits - 1);
+  return state;
+}
+
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <string_view>
+
+namespace ctcs::Detail_NS
+{
+  // Fixed-capacity buffer for the data produced at compile time.
+  //
+  // Memory allocated during constant evaluation cannot outlive it, so the output of a compressor
+  // has to be copied into an object of a literal type before it can be used as a template argument.
+  // The size of the output is unknown until the compressor has run; rather than running the compressor
+  // twice (first to compute the size, and then to get the data), the output is copied into a buffer
+  // of a guessed capacity. If the guess is wrong, only the size is stored, and the caller has to
+  // run the compressor again with the exact capacity.
+  template<std::size_t Capacity>
+  struct CompileTimeBuffer
+  {
+    constexpr CompileTimeBuffer() noexcept = default;
+
+    // Copies the given data into the buffer, if it fits.
+    explicit constexpr CompileTimeBuffer(std::string_view data) noexcept:
+      size(data.size())
+    {
+      if (complete())
+      {
+        for (std::size_t i = 0; i < size; ++i)
+        {
+          this->data[i] = data[i];
+        }
+      }
+    }
+
+    // \return true if the buffer contains the whole data, false if only the size is valid.
+    constexpr bool complete() const noexcept
+    {
+      return size <= Capacity;
+    }
+
+    std::array<char, Capacity> data {};
+    // The size of the data.
+    std::size_t size = 0;
+  };
+
+  // Returns the capacity to try first for the output of a compressor.
+  // Compressed data is almost always smaller than the input: the extra bytes cover the header.
+  constexpr std::size_t guessCompressedCapacity(std::size_t input_size) noexcept
+  {
+    return input_size + 16;
+  }
+
+  // The output of an encoder that runs at compile time.
+  //
+  // Runs the encoder with the guessed capacity, and, only if the output doesn't fit, once again
+  // with the exact capacity.
+  // \param Encoder - class with a static member function template `run<Capacity>()`, which returns
+  //        an object whose member `data` is CompileTimeBuffer<Capacity>.
+  // \param GuessedCapacity - the capacity to try first.
+  template<class Encoder, std::size_t GuessedCapacity>
+  class CompileTimeOutput
+  {
+    static constexpr auto kFirstRun = Encoder::template run<GuessedCapacity>();
+
+  public:
+    static constexpr auto kValue = []()
+    {
+      if constexpr (kFirstRun.data.complete())
+      {
+        return kFirstRun;
+      }
+      else
+      {
+        return Encoder::template run<kFirstRun.data.size>();
+      }
+    }();
+  };
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#define CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_NOINLINE __declspec(noinline)
+#else
+#define CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_NOINLINE [[gnu::noinline]]
+#endif
+
+namespace ctcs::Detail_NS
+{
+  // Searching the cumulative frequencies of a model for the symbol that contains the given point.
+  //
+  // The search is split into 2 phases: a binary search narrows the range down to a block of at most
+  // kBlockSize cumulative frequencies, and then the frequencies in the block that don't exceed the
+  // point are counted with vector comparisons (8 at a time with AVX2, 4 at a time with SSE2).
+  // The block is scanned without any data-dependent branches, so the rare symbols, which are the
+  // slowest to find via std::upper_bound, don't cause branch mispredictions.
+  //
+  // The instruction set is chosen at compile time (e.g., -mavx2 or /arch:AVX2 enables AVX2) rather than
+  // via CPUID; other platforms and constant evaluation use std::upper_bound. The vectorized search is
+  // never inlined: it's meant for the rare long searches, and keeping it out of the callers allows
+  // the compiler to inline the models themselves into the decoding loop.
+  class CumulativeFrequencySearch
+  {
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+
+#if defined(CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_AVX2)
+    static constexpr std::size_t kVectorSize = 8;
+#elif defined(CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_SSE2)
+    static constexpr std::size_t kVectorSize = 4;
+#else
+    static constexpr std::size_t kVectorSize = 1;
+#endif
+    // The maximum number of elements that are scanned after the binary search.
+    static constexpr std::size_t kBlockSize = 4 * kVectorSize;
+
+    // The vector comparisons are signed, so the frequencies must fit into a signed integer.
+    static_assert(ArithmeticCoding_NS::ArithmeticCodingTraits::kMaxFrequency <=
+                  static_cast<FrequencyCount>(std::numeric_limits<std::int32_t>::max()));
+
+    // Find the symbol whose interval [lower, upper) contains the specified value.
+    // \param cumulative_frequencies - non-decreasing cumulative frequencies; the interval of the i-th
+    //        symbol is [cumulative_frequencies[i]; cumulative_frequencies[i + 1]). All of them must
+    //        not exceed ArithmeticCodingTraits::kMaxFrequency.
+    // \param value - input point. Must be within [cumulative_frequencies.front(); cumulative_frequencies.back()).
+    // \return index i such that cumulative_frequencies[i] <= value < cumulative_frequencies[i + 1].
+    static constexpr std::size_t find(std::span<const FrequencyCount> cumulative_frequencies,
+                                      FrequencyCount value) noexcept
+    {
+      assert(cumulative_frequencies.size() >= 2);
+      assert(cumulative_frequencies.front() <= value && value < cumulative_frequencies.back());
+      if constexpr (kVectorSize > 1)
+      {
+        if (!std::is_constant_evaluated())
+        {
+          return findVectorized(cumulative_frequencies, value);
+        }
+      }
+      // Iterator to the first element cumulative_frequencies[i] > value.
+      const auto iter = std::upper_bound(cumulative_frequencies.begin() + 1, cumulative_frequencies.end() - 1, value);
+      return static_cast<std::size_t>(iter - cumulative_frequencies.begin()) - 1;
+    }
+
+  private:
+    CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_NOINLINE
+    static std::size_t findVectorized(std::span<const FrequencyCount> cumulative_frequencies,
+                                      FrequencyCount value) noexcept
+    {
+      // The answer is in [first - 1; first + count - 1]: cumulative_frequencies[first - 1] <= value, and
+      // the elements after cumulative_frequencies[first + count - 1] are greater than value.
+      std::size_t first = 1;
+      std::size_t count = cumulative_frequencies.size() - 2;
+      while (count > kBlockSize)
+      {
+        const std::size_t half = count / 2;
+        if (cumulative_frequencies[first + half] <= value)
+        {
+          first += half + 1;
+          count -= half + 1;
+        }
+        else
+        {
+          count = half;
+        }
+      }
+      return first - 1 + countNotGreater(cumulative_frequencies.data() + first, count, value);
+    }
+
+    // \return the number of elements among data[0], ..., data[count - 1] that don't exceed value.
+    static std::size_t countNotGreater(const FrequencyCount* data, std::size_t count, FrequencyCount value) noexcept
+    {
+      std::size_t result = 0;
+      std::size_t i = 0;
+#if defined(CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_AVX2)
+      const __m256i point = _mm256_set1_epi32(static_cast<int>(value));
+      for (; i + kVectorSize <= count; i += kVectorSize)
+      {
+        const __m256i elements = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        const __m256i greater = _mm256_cmpgt_epi32(elements, point);
+        result += kVectorSize - static_cast<std::size_t>(
+          std::popcount(static_cast<unsigned int>(_mm256_movemask_ps(_mm256_castsi256_ps(greater)))));
+      }
+#elif defined(CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_SSE2)
+      const __m128i point = _mm_set1_epi32(static_cast<int>(value));
+      for (; i + kVectorSize <= count; i += kVectorSize)
+      {
+        const __m128i elements = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        const __m128i greater = _mm_cmpgt_epi32(elements, point);
+        result += kVectorSize - static_cast<std::size_t>(
+          std::popcount(static_cast<unsigned int>(_mm_movemask_ps(_mm_castsi128_ps(greater)))));
+      }
+#endif
+      for (; i < count; ++i)
+      {
+        result += (data[i] <= value) ? 1 : 0;
+      }
+      return result;
+    }
+  };
+}
+
+#undef CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_AVX2
+#undef CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_SSE2
+#undef CTCS_DETAIL_CUMULATIVE_FREQUENCY_SEARCH_NOINLINE
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdlib>
+
+// The library can be used with exceptions disabled (-fno-exceptions in GCC and Clang, no /EHsc in MSVC).
+// In this case, the errors that would throw an exception terminate the program via std::abort(),
+// and the try blocks run without handlers.
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define CTCS_HAS_EXCEPTIONS 1
+#else
+#define CTCS_HAS_EXCEPTIONS 0
+#endif
+
+#if CTCS_HAS_EXCEPTIONS
+// Throws the given exception.
+#define CTCS_THROW(...) throw __VA_ARGS__
+// Replacements for try, catch (declaration) and throw; (rethrowing the current exception).
+#define CTCS_TRY try
+#define CTCS_CATCH(...) catch (__VA_ARGS__)
+#define CTCS_RETHROW throw
+#else
+#define CTCS_THROW(...) ::std::abort()
+#define CTCS_TRY if (true)
+#define CTCS_CATCH(...) if (false)
+#define CTCS_RETHROW static_cast<void>(0)
+#endif
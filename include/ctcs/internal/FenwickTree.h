@@ -0,0 +1,103 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <span>
+
+namespace ctcs::Detail_NS
+{
+  // Result of FenwickTree::find().
+  template<class T>
+  struct FenwickTreeFindResult
+  {
+    // Index of the found element.
+    std::size_t index;
+    // Sum of the elements preceding the found one.
+    T prefix_sum;
+  };
+
+  // Fenwick tree (binary indexed tree) over N non-negative values.
+  //
+  // Both updating a value and computing a prefix sum take O(log N) time.
+  // \param T - unsigned integer type of the values.
+  // \param N - the number of values.
+  template<class T, std::size_t N>
+  class FenwickTree
+  {
+  public:
+    // Constructs a tree where all values are 0.
+    constexpr FenwickTree() noexcept = default;
+
+    // Constructs a tree for the given values in O(N) time.
+    explicit constexpr FenwickTree(std::span<const T, N> values) noexcept;
+
+    // Adds delta to the value at the specified index.
+    // \param index - index of the value. Must be less than N.
+    // \param delta - the value to add. The sum must remain non-negative.
+    constexpr void add(std::size_t index, T delta) noexcept;
+
+    // \return the sum of the values [0; index).
+    constexpr T prefixSum(std::size_t index) const noexcept;
+
+    // Find the element i such that prefixSum(i) <= value < prefixSum(i + 1).
+    // \param value - input value. Must be less than prefixSum(N).
+    // \return the index of the element and prefixSum(index).
+    constexpr FenwickTreeFindResult<T> find(T value) const noexcept;
+
+  private:
+    // 1-based array: tree_[i] is the sum of the values (i - lowbit(i); i].
+    std::array<T, N + 1> tree_{};
+  };
+
+  template<class T, std::size_t N>
+  constexpr FenwickTree<T, N>::FenwickTree(std::span<const T, N> values) noexcept
+  {
+    for (std::size_t i = 1; i <= N; ++i)
+    {
+      tree_[i] += values[i - 1];
+      const std::size_t parent = i + (i & (~i + 1));
+      if (parent <= N)
+      {
+        tree_[parent] += tree_[i];
+      }
+    }
+  }
+
+  template<class T, std::size_t N>
+  constexpr void FenwickTree<T, N>::add(std::size_t index, T delta) noexcept
+  {
+    for (std::size_t i = index + 1; i <= N; i += (i & (~i + 1)))
+    {
+      tree_[i] += delta;
+    }
+  }
+
+  template<class T, std::size_t N>
+  constexpr T FenwickTree<T, N>::prefixSum(std::size_t index) const noexcept
+  {
+    T result{};
+    for (std::size_t i = index; i > 0; i &= i - 1)
+    {
+      result += tree_[i];
+    }
+    return result;
+  }
+
+  template<class T, std::size_t N>
+  constexpr FenwickTreeFindResult<T> FenwickTree<T, N>::find(T value) const noexcept
+  {
+    std::size_t position = 0;
+    T prefix_sum{};
+    for (std::size_t step = std::bit_floor(N); step > 0; step >>= 1)
+    {
+      const std::size_t next = position + step;
+      if (next <= N && prefix_sum + tree_[next] <= value)
+      {
+        position = next;
+        prefix_sum += tree_[next];
+      }
+    }
+    return FenwickTreeFindResult<T>{ .index = position, .prefix_sum = prefix_sum };
+  }
+}
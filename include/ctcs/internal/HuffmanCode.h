@@ -0,0 +1,231 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ctcs::Huffman_NS
+{
+
+// Parameters of the canonical Huffman code.
+class HuffmanCodeTraits
+{
+public:
+  // The number of symbols in the alphabet.
+  static constexpr std::size_t kNumSymbols = 256;
+  // The maximum length of a code word.
+  static constexpr unsigned int kMaxCodeLength = 24;
+  // The number of bits used to index the decoding table.
+  static constexpr unsigned int kLookupBits = 10;
+
+  static_assert(kLookupBits <= kMaxCodeLength, "kLookupBits must not exceed kMaxCodeLength.");
+};
+
+// Computes the lengths of the code words of a Huffman code for the given frequencies.
+//
+// If the longest code word exceeds HuffmanCodeTraits::kMaxCodeLength, the frequencies are
+// halved and the code is rebuilt, until the limit is satisfied.
+// \param frequencies - frequencies of the symbols. Symbols with zero frequency get no code word.
+// \return the length of the code word for each symbol (0 for symbols with zero frequency).
+constexpr std::array<unsigned char, HuffmanCodeTraits::kNumSymbols>
+computeCodeLengths(std::array<std::uint64_t, HuffmanCodeTraits::kNumSymbols> frequencies)
+{
+  constexpr std::size_t kNumSymbols = HuffmanCodeTraits::kNumSymbols;
+  std::array<unsigned char, kNumSymbols> lengths{};
+  while (true)
+  {
+    // Symbols with nonzero frequencies, sorted by their frequencies.
+    std::array<std::size_t, kNumSymbols> leaves{};
+    std::size_t num_leaves = 0;
+    for (std::size_t i = 0; i < kNumSymbols; ++i)
+    {
+      if (frequencies[i] != 0)
+      {
+        leaves[num_leaves++] = i;
+      }
+    }
+    std::sort(leaves.begin(), leaves.begin() + num_leaves,
+              [&frequencies](std::size_t lhs, std::size_t rhs)
+              {
+                return std::pair(frequencies[lhs], lhs) < std::pair(frequencies[rhs], rhs);
+              });
+    lengths = {};
+    if (num_leaves == 0)
+    {
+      return lengths;
+    }
+    if (num_leaves == 1)
+    {
+      lengths[leaves[0]] = 1;
+      return lengths;
+    }
+    // Nodes [0; kNumSymbols) are the leaves; the internal nodes are created in the order of
+    // non-decreasing weights, so the two-queue algorithm can be used.
+    std::array<std::uint64_t, 2 * kNumSymbols> weights{};
+    std::array<std::size_t, 2 * kNumSymbols> parents{};
+    for (std::size_t i = 0; i < kNumSymbols; ++i)
+    {
+      weights[i] = frequencies[i];
+    }
+    std::size_t next_leaf = 0;
+    std::size_t next_internal = kNumSymbols;
+    const std::size_t num_internal_nodes = num_leaves - 1;
+    // Removes the lightest node from the queues.
+    // \param end_internal - index of the next internal node to be created.
+    const auto pop_min = [&](std::size_t end_internal) -> std::size_t
+    {
+      if (next_leaf < num_leaves &&
+          (next_internal == end_internal || weights[leaves[next_leaf]] <= weights[next_internal]))
+      {
+        return leaves[next_leaf++];
+      }
+      return next_internal++;
+    };
+    for (std::size_t i = 0; i < num_internal_nodes; ++i)
+    {
+      const std::size_t node = kNumSymbols + i;
+      const std::size_t first = pop_min(node);
+      const std::size_t second = pop_min(node);
+      weights[node] = weights[first] + weights[second];
+      parents[first] = node;
+      parents[second] = node;
+    }
+    // Parents are always created after their children, so the depths can be computed in reverse order.
+    std::array<unsigned int, 2 * kNumSymbols> depths{};
+    const std::size_t root = kNumSymbols + num_internal_nodes - 1;
+    for (std::size_t node = root; node-- > kNumSymbols;)
+    {
+      depths[node] = depths[parents[node]] + 1;
+    }
+    unsigned int max_length = 0;
+    for (std::size_t i = 0; i < num_leaves; ++i)
+    {
+      const std::size_t symbol = leaves[i];
+      const unsigned int depth = depths[parents[symbol]] + 1;
+      lengths[symbol] = static_cast<unsigned char>(std::min(depth, 255u));
+      max_length = std::max(max_length, depth);
+    }
+    if (max_length <= HuffmanCodeTraits::kMaxCodeLength)
+    {
+      return lengths;
+    }
+    for (std::uint64_t& frequency : frequencies)
+    {
+      if (frequency != 0)
+      {
+        frequency = std::max<std::uint64_t>(frequency / 2, 1);
+      }
+    }
+  }
+}
+
+// Canonical Huffman code.
+class CanonicalCode
+{
+public:
+  // Constructs the canonical code for the given code lengths.
+  explicit constexpr CanonicalCode(const std::array<unsigned char, HuffmanCodeTraits::kNumSymbols>& lengths) noexcept;
+
+  // The length of the code word for each symbol.
+  std::array<unsigned char, HuffmanCodeTraits::kNumSymbols> lengths{};
+  // The code word for each symbol.
+  std::array<std::uint32_t, HuffmanCodeTraits::kNumSymbols> codes{};
+  // The symbols sorted by (length, symbol).
+  std::array<unsigned char, HuffmanCodeTraits::kNumSymbols> sorted_symbols{};
+  // first_codes[i] is the smallest code word of length i.
+  std::array<std::uint32_t, HuffmanCodeTraits::kMaxCodeLength + 1> first_codes{};
+  // first_indices[i] is the index in sorted_symbols of the first symbol with the code word of length i.
+  std::array<std::uint16_t, HuffmanCodeTraits::kMaxCodeLength + 1> first_indices{};
+  // counts[i] is the number of code words of length i.
+  std::array<std::uint16_t, HuffmanCodeTraits::kMaxCodeLength + 1> counts{};
+};
+
+constexpr CanonicalCode::CanonicalCode(const std::array<unsigned char, HuffmanCodeTraits::kNumSymbols>& code_lengths) noexcept:
+  lengths(code_lengths)
+{
+  for (unsigned char length : lengths)
+  {
+    if (length != 0)
+    {
+      ++counts[length];
+    }
+  }
+  std::uint32_t code = 0;
+  std::uint16_t index = 0;
+  for (unsigned int length = 1; length <= HuffmanCodeTraits::kMaxCodeLength; ++length)
+  {
+    code = (code + counts[length - 1]) << 1;
+    first_codes[length] = code;
+    first_indices[length] = index;
+    index = static_cast<std::uint16_t>(index + counts[length]);
+  }
+  // Assign the code words in the order of (length, symbol).
+  std::array<std::uint32_t, HuffmanCodeTraits::kMaxCodeLength + 1> next_codes = first_codes;
+  std::array<std::uint16_t, HuffmanCodeTraits::kMaxCodeLength + 1> next_indices = first_indices;
+  for (std::size_t symbol = 0; symbol < HuffmanCodeTraits::kNumSymbols; ++symbol)
+  {
+    const unsigned char length = lengths[symbol];
+    if (length != 0)
+    {
+      codes[symbol] = next_codes[length]++;
+      sorted_symbols[next_indices[length]++] = static_cast<unsigned char>(symbol);
+    }
+  }
+}
+
+// Entry of the decoding table.
+struct DecodeTableEntry
+{
+  // Up to 2 symbols whose code words are fully contained in the indexing bits.
+  std::array<unsigned char, 2> symbols;
+  // Lengths of the code words of the symbols; 0 if there is no such symbol.
+  // If lengths[0] is 0, then the code word is longer than kLookupBits.
+  std::array<unsigned char, 2> lengths;
+};
+
+// Decoding table, indexed by the next kLookupBits bits of the stream.
+using DecodeTable = std::array<DecodeTableEntry, std::size_t{ 1 } << HuffmanCodeTraits::kLookupBits>;
+
+// Builds the decoding table for the given canonical code.
+constexpr DecodeTable makeDecodeTable(const CanonicalCode& code) noexcept
+{
+  constexpr unsigned int kLookupBits = HuffmanCodeTraits::kLookupBits;
+  DecodeTable table{};
+  // Fill in the first symbol.
+  for (std::size_t symbol = 0; symbol < HuffmanCodeTraits::kNumSymbols; ++symbol)
+  {
+    const unsigned int length = code.lengths[symbol];
+    if (length == 0 || length > kLookupBits)
+    {
+      continue;
+    }
+    const unsigned int num_free_bits = kLookupBits - length;
+    const std::size_t first = static_cast<std::size_t>(code.codes[symbol]) << num_free_bits;
+    for (std::size_t i = 0; i < (std::size_t{ 1 } << num_free_bits); ++i)
+    {
+      table[first + i].symbols[0] = static_cast<unsigned char>(symbol);
+      table[first + i].lengths[0] = static_cast<unsigned char>(length);
+    }
+  }
+  // Fill in the second symbol: the bits after the first code word index the table as well.
+  for (std::size_t i = 0; i < table.size(); ++i)
+  {
+    const unsigned int length = table[i].lengths[0];
+    if (length == 0)
+    {
+      continue;
+    }
+    const std::size_t rest = (i << length) & (table.size() - 1);
+    const DecodeTableEntry& next = table[rest];
+    if (next.lengths[0] != 0 && next.lengths[0] <= kLookupBits - length)
+    {
+      table[i].symbols[1] = next.symbols[0];
+      table[i].lengths[1] = next.lengths[0];
+    }
+  }
+  return table;
+}
+
+}
@@ -1,14 +1,31 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 namespace ctcs::ArithmeticCoding_NS
 {
 
+// Result of IBitStream::get(num_bits).
+struct ReadBitsResult
+{
+  // The bits read from the stream; the first bit read is the most significant one.
+  std::uint64_t value;
+  // The number of bits that were actually available in the stream.
+  unsigned int num_bits_read;
+};
+
 // Wrapper for std::span<const char>, which reads data bit by bit.
+//
+// The bits are buffered 64 at a time, so reading several bits at once is cheap.
 class IBitStream
 {
 public:
+  // The maximum number of bits that can be read by a single call to get(num_bits).
+  static constexpr unsigned int kMaxBitsPerRead = 57;
+
   // Constructs an empty stream.
   constexpr IBitStream() noexcept = default;
 
@@ -29,15 +46,41 @@ public:
   // \return the value of the bit, or std::nullopt if the end of the stream has been reached.
   constexpr std::optional<bool> get();
 
+  // Read several bits from the underlying stream.
+  // If the end of the stream is reached, the missing bits are filled with zeros.
+  // \param num_bits - the number of bits to read. Must not exceed kMaxBitsPerRead.
+  // \return the bits read and the number of bits that were actually available.
+  constexpr ReadBitsResult get(unsigned int num_bits);
+
+  // Returns the next bits from the underlying stream without consuming them.
+  // If the end of the stream is reached, the missing bits are filled with zeros.
+  // \param num_bits - the number of bits to peek. Must not exceed kMaxBitsPerRead.
+  // \return the bits; the first one is the most significant.
+  constexpr std::uint64_t peek(unsigned int num_bits);
+
+  // Consumes the bits that have been returned by the last call to peek().
+  // \param num_bits - the number of bits to consume. Must not exceed the number of bits
+  //        passed to the last call to peek().
+  // \return the number of bits that were actually available in the stream.
+  constexpr unsigned int skip(unsigned int num_bits) noexcept;
+
 private:
+  // Bytes are always read with only 8 bits, even if CHAR_BIT > 8 on this platform.
+  static constexpr unsigned int kNumBitsInByte = 8;
+  static constexpr unsigned int kNumBitsInBuffer = 64;
+
+  // Loads as many bytes from the stream into the buffer as possible.
+  constexpr void refill() noexcept;
+
   // Pointer to the next character in the stream.
   const char* stream_ = nullptr;
   // Pointer past the last character in the stream.
   const char* stream_end_ = nullptr;
-  // Current character.
-  unsigned char buffer_ = 0;
+  // Bits that have been loaded from the stream, but haven't been read yet.
+  // The next bit to read is the most significant one.
+  std::uint64_t buffer_ = 0;
   // The number of bits in buffer_ that haven't been read yet.
-  unsigned char num_bits_in_buffer_ = 0;
+  unsigned int num_bits_in_buffer_ = 0;
 };
 
 constexpr IBitStream::IBitStream(const char* stream, std::size_t num_characters) noexcept:
@@ -72,18 +115,58 @@ constexpr IBitStream& IBitStream::operator=(IBitStream&& other) noexcept
 
 constexpr std::optional<bool> IBitStream::get()
 {
-  constexpr std::size_t kNumBitsInByte = 8;
-
   if (num_bits_in_buffer_ == 0)
   {
-    if (stream_ == stream_end_)
+    refill();
+    if (num_bits_in_buffer_ == 0)
     {
       return std::nullopt;
     }
-    buffer_ = static_cast<unsigned char>(*stream_++);
-    num_bits_in_buffer_ = kNumBitsInByte;
   }
-  return static_cast<bool>((buffer_ >> (--num_bits_in_buffer_)) & 1);
+  const bool bit = static_cast<bool>(buffer_ >> (kNumBitsInBuffer - 1));
+  buffer_ <<= 1;
+  --num_bits_in_buffer_;
+  return bit;
+}
+
+constexpr ReadBitsResult IBitStream::get(unsigned int num_bits)
+{
+  if (num_bits_in_buffer_ < num_bits)
+  {
+    refill();
+  }
+  const unsigned int num_bits_read = std::min(num_bits, num_bits_in_buffer_);
+  const std::uint64_t bits = (num_bits_read == 0) ? 0 : (buffer_ >> (kNumBitsInBuffer - num_bits_read));
+  buffer_ <<= num_bits_read;
+  num_bits_in_buffer_ -= num_bits_read;
+  return ReadBitsResult{ .value = bits << (num_bits - num_bits_read), .num_bits_read = num_bits_read };
+}
+
+constexpr std::uint64_t IBitStream::peek(unsigned int num_bits)
+{
+  if (num_bits_in_buffer_ < num_bits)
+  {
+    refill();
+  }
+  return (num_bits == 0) ? 0 : (buffer_ >> (kNumBitsInBuffer - num_bits));
+}
+
+constexpr unsigned int IBitStream::skip(unsigned int num_bits) noexcept
+{
+  const unsigned int num_bits_skipped = std::min(num_bits, num_bits_in_buffer_);
+  buffer_ <<= num_bits_skipped;
+  num_bits_in_buffer_ -= num_bits_skipped;
+  return num_bits_skipped;
+}
+
+constexpr void IBitStream::refill() noexcept
+{
+  while (num_bits_in_buffer_ <= kNumBitsInBuffer - kNumBitsInByte && stream_ != stream_end_)
+  {
+    const std::uint64_t byte = static_cast<unsigned char>(*stream_++);
+    buffer_ |= byte << (kNumBitsInBuffer - kNumBitsInByte - num_bits_in_buffer_);
+    num_bits_in_buffer_ += kNumBitsInByte;
+  }
 }
 
 }
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "Exceptions.h"
+#include "RangeCoder.h"
+#include "RangeCoding.h"
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Range encoder that distributes the symbols among NumStates independent RangeCoders.
+//
+// The i-th symbol is encoded by the state (i % NumStates). The bytes produced by the states are
+// interleaved into a single stream in exactly the order in which InterleavedRangeDecoder reads them,
+// so the decoder needs neither per-state offsets nor per-state sizes.
+//
+// The order is determined by simulating the decoder: before decoding its first symbol, a state reads
+// RangeCodingTraits::kCodeValueBytes bytes; after decoding each symbol, it reads as many bytes as
+// RangeCoder has shifted out while encoding it. Hence the stream can only be written by finalize().
+//
+// The models are not duplicated: the caller should use a single model for all states.
+template<std::size_t NumStates>
+class InterleavedRangeCoder
+{
+public:
+  static_assert(NumStates >= 1, "NumStates must be positive.");
+
+  // Constructs a coder that appends the encoded bytes to the given string.
+  explicit constexpr InterleavedRangeCoder(std::string& dest);
+
+  // Non-copyable, non-movable.
+  InterleavedRangeCoder(const InterleavedRangeCoder&) = delete;
+  InterleavedRangeCoder(InterleavedRangeCoder&&) = delete;
+  InterleavedRangeCoder& operator=(const InterleavedRangeCoder&) = delete;
+  InterleavedRangeCoder& operator=(InterleavedRangeCoder&&) = delete;
+
+  // Destructor.
+  //
+  // Calls finalize() under the hood. If finalize() throws any exception, it is suppressed in the destructor.
+  constexpr ~InterleavedRangeCoder();
+
+  // Encodes the next symbol with the next state.
+  template<ArithmeticCodingModel Model>
+  constexpr void encode(const Model& model, typename Model::char_type symbol);
+
+  // Interleaves the bytes produced by the states and writes them to the output string.
+  //
+  // The trailing zero bytes are omitted: the decoder treats the bytes past the end of the stream as zeros.
+  constexpr void finalize();
+
+private:
+  // The output string for encoded data.
+  std::string* dest_ = nullptr;
+  // The bytes produced by each state.
+  std::array<std::string, NumStates> streams_;
+  // The states.
+  std::array<std::optional<RangeCoder>, NumStates> coders_;
+  // The number of bytes shifted out after encoding each symbol.
+  std::vector<unsigned char> num_shifted_bytes_;
+};
+
+template<std::size_t NumStates>
+constexpr InterleavedRangeCoder<NumStates>::InterleavedRangeCoder(std::string& dest):
+  dest_(&dest)
+{
+  for (std::size_t state = 0; state < NumStates; ++state)
+  {
+    coders_[state].emplace(streams_[state]);
+  }
+}
+
+template<std::size_t NumStates>
+constexpr InterleavedRangeCoder<NumStates>::~InterleavedRangeCoder()
+{
+  CTCS_TRY
+  {
+    finalize();
+  }
+  CTCS_CATCH(...)
+  {
+  }
+}
+
+template<std::size_t NumStates>
+template<ArithmeticCodingModel Model>
+constexpr void InterleavedRangeCoder<NumStates>::encode(const Model& model, typename Model::char_type symbol)
+{
+  if (!dest_)
+  {
+    CTCS_THROW(std::runtime_error("InterleavedRangeCoder::encode(): finalize() has already been called."));
+  }
+  const std::size_t state = num_shifted_bytes_.size() % NumStates;
+  num_shifted_bytes_.push_back(static_cast<unsigned char>(coders_[state]->encode(model, symbol)));
+}
+
+template<std::size_t NumStates>
+constexpr void InterleavedRangeCoder<NumStates>::finalize()
+{
+  if (!dest_)
+  {
+    return;
+  }
+  for (std::optional<RangeCoder>& coder : coders_)
+  {
+    coder->finalize();
+  }
+  // Replay the reads of the decoder. RangeCoder omits the trailing zero bytes of each state,
+  // so the missing bytes are written as zeros.
+  std::array<std::size_t, NumStates> positions {};
+  const std::size_t offset = dest_->size();
+  const auto copyBytes = [&](std::size_t state, std::size_t num_bytes)
+  {
+    for (std::size_t i = 0; i < num_bytes; ++i, ++positions[state])
+    {
+      dest_->push_back(positions[state] < streams_[state].size() ? streams_[state][positions[state]] : '\0');
+    }
+  };
+  for (std::size_t i = 0; i < num_shifted_bytes_.size(); ++i)
+  {
+    const std::size_t state = i % NumStates;
+    if (i < NumStates)
+    {
+      copyBytes(state, RangeCodingTraits::kCodeValueBytes);
+    }
+    copyBytes(state, num_shifted_bytes_[i]);
+  }
+  // Drop the trailing zeros.
+  const std::size_t last_nonzero = dest_->find_last_not_of('\0');
+  dest_->resize((last_nonzero == std::string::npos || last_nonzero < offset) ? offset : last_nonzero + 1);
+  dest_ = nullptr;
+}
+
+}
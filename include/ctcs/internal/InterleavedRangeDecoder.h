@@ -0,0 +1,115 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "Exceptions.h"
+#include "RangeCoding.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Decoder for the data encoded by InterleavedRangeCoder.
+//
+// The states are independent of each other, except that they read from the same stream. Thus, when
+// the symbols are decoded in a loop over the states, the CPU can overlap the divisions and the
+// model lookups of different states.
+template<std::size_t NumStates>
+class InterleavedRangeDecoder
+{
+public:
+  using CodeValue = RangeCodingTraits::CodeValue;
+  using FrequencyCount = RangeCodingTraits::FrequencyCount;
+
+  static_assert(NumStates >= 1, "NumStates must be positive.");
+
+  // Constructs a decoder for the data encoded by InterleavedRangeCoder.
+  explicit constexpr InterleavedRangeDecoder(std::string_view data) noexcept;
+
+  // Initializes the given state.
+  // Must be called right before decoding the first symbol of the state, i.e. the symbol with index `state`.
+  constexpr void start(std::size_t state);
+
+  // Decodes the next symbol of the given state.
+  template<ArithmeticCodingModel Model>
+  constexpr typename Model::char_type decode(const Model& model, std::size_t state);
+
+private:
+  constexpr unsigned char readByte();
+
+  // Pointer to the next byte in the stream.
+  const char* stream_ = nullptr;
+  // Pointer past the last byte in the stream.
+  const char* stream_end_ = nullptr;
+  // InterleavedRangeCoder omits the trailing zero bytes, but never more than a code value per state.
+  std::size_t num_garbage_bytes_ = 0;
+  // Currently-seen code value relative to the left endpoint of the current range, for each state.
+  std::array<CodeValue, NumStates> code_ {};
+  // Width of the current range, for each state.
+  std::array<CodeValue, NumStates> range_ {};
+};
+
+template<std::size_t NumStates>
+constexpr InterleavedRangeDecoder<NumStates>::InterleavedRangeDecoder(std::string_view data) noexcept:
+  stream_(data.data()),
+  stream_end_(data.data() + data.size())
+{
+}
+
+template<std::size_t NumStates>
+constexpr void InterleavedRangeDecoder<NumStates>::start(std::size_t state)
+{
+  range_[state] = RangeCodingTraits::kTopValue;
+  // Read the first bytes to fill the code value.
+  for (unsigned int i = 0; i < RangeCodingTraits::kCodeValueBytes; ++i)
+  {
+    code_[state] = (code_[state] << 8) | readByte();
+  }
+}
+
+template<std::size_t NumStates>
+template<ArithmeticCodingModel Model>
+constexpr typename Model::char_type InterleavedRangeDecoder<NumStates>::decode(const Model& model, std::size_t state)
+{
+  CodeValue code = code_[state];
+  CodeValue range = range_[state];
+  const FrequencyCount scaling_factor = model.scalingFactor();
+  const CodeValue step = range / scaling_factor;
+  // The range may be slightly wider than step * scaling_factor, so clamp the point.
+  const FrequencyCount point = static_cast<FrequencyCount>(
+    std::min<CodeValue>(code / step, scaling_factor - 1));
+  const DecodedSymbol<typename Model::char_type> decoded = decodeSymbol(model, point);
+  // Narrow the range to that alloted to this symbol.
+  code -= step * decoded.interval.first;
+  range = step * (decoded.interval.second - decoded.interval.first);
+  // Perform renormalization, if needed.
+  while (range < RangeCodingTraits::kBottomValue)
+  {
+    code = (code << 8) | readByte();
+    range <<= 8;
+  }
+  code_[state] = code;
+  range_[state] = range;
+  return decoded.symbol;
+}
+
+template<std::size_t NumStates>
+constexpr unsigned char InterleavedRangeDecoder<NumStates>::readByte()
+{
+  if (stream_ != stream_end_)
+  {
+    return static_cast<unsigned char>(*stream_++);
+  }
+  ++num_garbage_bytes_;
+  if (num_garbage_bytes_ > RangeCodingTraits::kCodeValueBytes * NumStates)
+  {
+    CTCS_THROW(std::logic_error("InterleavedRangeDecoder: unexpected end of stream."));
+  }
+  return 0;
+}
+
+}
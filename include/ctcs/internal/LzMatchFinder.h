@@ -0,0 +1,177 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace ctcs::Lz_NS
+{
+
+// Parameters of the LZ77 parsing.
+class LzTraits
+{
+public:
+  // The minimum length of a match.
+  static constexpr std::size_t kMinMatchLength = 3;
+  // The maximum length of a match.
+  static constexpr std::size_t kMaxMatchLength = std::size_t{ 1 } << 15;
+  // The maximum distance between a match and its source.
+  static constexpr std::size_t kMaxDistance = std::size_t{ 1 } << 15;
+  // The number of bit length classes used to encode the lengths and the distances:
+  // integers from [1; kMaxMatchLength] and [1; kMaxDistance] have at most kNumBitClasses bits.
+  static constexpr std::size_t kNumBitClasses = 16;
+  // Binary logarithm of the number of hash chains.
+  static constexpr unsigned int kHashBits = 14;
+  // The maximum number of candidates examined when searching for a match.
+  static constexpr std::size_t kMaxChainLength = 32;
+};
+
+// A match: the next `length` characters are equal to the ones `distance` characters back.
+struct Match
+{
+  std::size_t length;
+  std::size_t distance;
+};
+
+// Hash-chain match finder.
+//
+// Positions are hashed by their first kMinMatchLength characters; positions with the same hash
+// are linked into a chain, from the most recent one to the oldest one. Searching only examines
+// the first kMaxChainLength candidates, so the total cost is linear in the size of the input,
+// which keeps it feasible in constant evaluation.
+class MatchFinder
+{
+public:
+  explicit constexpr MatchFinder(std::string_view data);
+
+  // Finds the longest match for the given position among the inserted positions.
+  // \return the longest match, or a match of length 0 if there are no matches of at least kMinMatchLength.
+  constexpr Match find(std::size_t position) const;
+
+  // Inserts the given position into its hash chain.
+  // The positions must be inserted in increasing order.
+  constexpr void insert(std::size_t position);
+
+private:
+  static constexpr std::uint32_t kNone = 0xFFFFFFFF;
+
+  constexpr std::size_t hash(std::size_t position) const noexcept;
+
+  std::string_view data_;
+  // The most recent position for each hash.
+  std::vector<std::uint32_t> heads_;
+  // The previous position with the same hash for each position.
+  std::vector<std::uint32_t> previous_;
+};
+
+constexpr MatchFinder::MatchFinder(std::string_view data):
+  data_(data),
+  heads_(std::size_t{ 1 } << LzTraits::kHashBits, kNone),
+  previous_(data.size(), kNone)
+{
+}
+
+constexpr Match MatchFinder::find(std::size_t position) const
+{
+  Match best{ .length = 0, .distance = 0 };
+  if (data_.size() - position < LzTraits::kMinMatchLength)
+  {
+    return best;
+  }
+  const std::size_t max_length = std::min(data_.size() - position, LzTraits::kMaxMatchLength);
+  std::uint32_t candidate = heads_[hash(position)];
+  for (std::size_t i = 0; i < LzTraits::kMaxChainLength && candidate != kNone; ++i)
+  {
+    const std::size_t distance = position - candidate;
+    if (distance > LzTraits::kMaxDistance)
+    {
+      break;
+    }
+    // Check the character that would extend the best match first.
+    if (data_[candidate + best.length] == data_[position + best.length])
+    {
+      std::size_t length = 0;
+      while (length < max_length && data_[candidate + length] == data_[position + length])
+      {
+        ++length;
+      }
+      if (length > best.length)
+      {
+        best = Match{ .length = length, .distance = distance };
+        if (length == max_length)
+        {
+          break;
+        }
+      }
+    }
+    candidate = previous_[candidate];
+  }
+  if (best.length < LzTraits::kMinMatchLength)
+  {
+    best = Match{ .length = 0, .distance = 0 };
+  }
+  return best;
+}
+
+constexpr void MatchFinder::insert(std::size_t position)
+{
+  if (data_.size() - position < LzTraits::kMinMatchLength)
+  {
+    return;
+  }
+  const std::size_t h = hash(position);
+  previous_[position] = heads_[h];
+  heads_[h] = static_cast<std::uint32_t>(position);
+}
+
+constexpr std::size_t MatchFinder::hash(std::size_t position) const noexcept
+{
+  const std::uint32_t value = (static_cast<std::uint32_t>(static_cast<unsigned char>(data_[position])) << 16) |
+                              (static_cast<std::uint32_t>(static_cast<unsigned char>(data_[position + 1])) << 8) |
+                              static_cast<std::uint32_t>(static_cast<unsigned char>(data_[position + 2]));
+  // Fibonacci hashing.
+  constexpr std::uint32_t kMultiplier = 2654435769u;
+  return static_cast<std::size_t>(static_cast<std::uint32_t>(value * kMultiplier) >> (32 - LzTraits::kHashBits));
+}
+
+// ArithmeticCodingModel for integers uniformly distributed in [0; 2^num_bits).
+class UniformModel
+{
+public:
+  using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+  using char_type = std::uint32_t;
+
+  explicit constexpr UniformModel(unsigned int num_bits) noexcept:
+    scaling_factor_(FrequencyCount{ 1 } << num_bits)
+  {}
+
+  constexpr FrequencyCount scalingFactor() const noexcept
+  {
+    return scaling_factor_;
+  }
+
+  constexpr char_type getCharByPoint(FrequencyCount value) const noexcept
+  {
+    return value;
+  }
+
+  constexpr ArithmeticCoding_NS::DecodedSymbol<char_type> decodeSymbol(FrequencyCount value) const noexcept
+  {
+    return { value, { value, value + 1 } };
+  }
+
+  constexpr std::pair<FrequencyCount, FrequencyCount> getInterval(char_type value) const noexcept
+  {
+    return { value, value + 1 };
+  }
+
+private:
+  FrequencyCount scaling_factor_;
+};
+
+}
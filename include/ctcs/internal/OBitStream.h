@@ -1,5 +1,10 @@
 #pragma once
 
+#include "Exceptions.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
 #include <string>
 
@@ -7,6 +12,10 @@ namespace ctcs::ArithmeticCoding_NS
 {
 
 // Wrapper for std::string, which writes data bit by bit.
+//
+// The string is grown in large steps and then trimmed by finalize(): appending characters one
+// at a time is very expensive during constant evaluation. Thus, the contents of the string are
+// only valid after finalize() (or the destructor) has been called.
 class OBitStream
 {
 public:
@@ -18,6 +27,12 @@ public:
   // Construct a wrapper for the given buffer.
   constexpr explicit OBitStream(std::string& dest) noexcept;
 
+  // Construct a wrapper for the given buffer, and make room for expected_size bytes at once.
+  // Growing the string is expensive during constant evaluation, so a good guess saves time.
+  // \param expected_size - the expected number of bytes to write. The string still grows
+  //        if more bytes are written.
+  constexpr OBitStream(std::string& dest, std::size_t expected_size);
+
   // Non-copyable, non-movable.
   OBitStream(const OBitStream&) = delete;
   OBitStream(OBitStream&& other) = delete;
@@ -32,13 +47,31 @@ public:
 
   // Writes the specified bit to the underlying ostream.
   //
-  // Does nothing if there is no underlying stream.
-  // Basic exception guarantee: if an exception is thrown during this operation, then the bit is not written.
+  // Same as put(bit, 1).
   // \param bit - bit to write.
   constexpr void put(bool bit);
 
-  // Writes uncommited bits to the underlying ostream.
+  // Writes the lowest num_bits bits of the given value, starting from the most significant one.
+  //
+  // Equivalent to calling put(bool) for each bit, but much cheaper, especially at compile time.
+  // The bits are buffered, and written to the underlying string a few bytes at a time.
+  // If an exception is thrown during this operation, then the bits remain in the buffer,
+  // and finalize() is the only member function that can be called.
+  // \param bits - bits to write. The bits above the lowest num_bits bits must be zero.
+  // \param num_bits - the number of bits to write; at most kMaxBitsPerPut.
+  constexpr void put(std::uint32_t bits, unsigned int num_bits);
+
+  // The maximum number of bits that can be written via a single call to put(bits, num_bits).
+  static constexpr unsigned int kMaxBitsPerPut = 32;
+
+  // \return the total number of bits in the underlying string, including the bits
+  //         that were added via put() but haven't been written to it yet.
+  constexpr std::size_t numBits() const noexcept;
+
+  // Writes uncommited bits to the underlying ostream, padding the last byte with zeros,
+  // and trims the underlying string to the written data.
   //
+  // The stream can still be written to after this call.
   // This is a potentially throwing operation, so this function is not marked noexcept.
   // Basic exception guarantee: if an exception is thrown during this operation, then the
   // associated stream and the uncommited bits remain the same.
@@ -50,12 +83,28 @@ public:
 private:
   // Bytes are always written with only 8 bits, even if CHAR_BIT > 8 on this platform.
   static constexpr unsigned char kNumBitsInByte = 8;
+  // The minimum number of bytes by which the underlying string is grown.
+  static constexpr std::size_t kMinGrowth = 64;
+
+  // Writes the full bytes from current_bits_ to the underlying string.
+  constexpr void writeFullBytes();
+
+  // Writes a byte to the underlying string, growing it if needed.
+  constexpr void putByte(unsigned char byte);
+
+  // Grows the underlying string by at least kMinGrowth bytes.
+  constexpr void grow();
 
   std::string& dest_;
+  // The number of bytes written to dest_. dest_.size() may be greater until finalize() is called.
+  std::size_t size_ = dest_.size();
+  // The value of size_ after the last call to finalize().
+  std::size_t finalized_size_ = size_;
   // Stores the bits that were added via put() but haven't been written to dest_ yet.
-  unsigned char current_byte_ = 0;
-  // The number of bits written to current_byte_.
-  unsigned char num_bits_ = 0;
+  // Only the lowest num_bits_ bits are used.
+  std::uint64_t current_bits_ = 0;
+  // The number of bits in current_bits_. Always less than kMaxBitsPerPut between the calls to put().
+  unsigned int num_bits_ = 0;
 };
 
 constexpr OBitStream::OBitStream(std::string& dest) noexcept :
@@ -63,42 +112,96 @@ constexpr OBitStream::OBitStream(std::string& dest) noexcept :
 {
 }
 
+constexpr OBitStream::OBitStream(std::string& dest, std::size_t expected_size) :
+  dest_(dest)
+{
+  dest_.resize(size_ + expected_size);
+}
+
 constexpr OBitStream::~OBitStream()
 {
-  try
+  CTCS_TRY
   {
     finalize();
   }
-  catch (...)
+  CTCS_CATCH(...)
   {
   }
 }
 
 constexpr void OBitStream::put(bool bit)
 {
-  // If the buffer is full, write the byte to output stream.
-  if (num_bits_ == kNumBitsInByte)
+  put(static_cast<std::uint32_t>(bit), 1);
+}
+
+constexpr void OBitStream::put(std::uint32_t bits, unsigned int num_bits)
+{
+  // Append the bits to the buffer.
+  current_bits_ = (current_bits_ << num_bits) | bits;
+  num_bits_ += num_bits;
+  // Write the full bytes only when the buffer is half full: each call is expensive at compile time.
+  if (num_bits_ >= kMaxBitsPerPut)
   {
-    dest_.push_back(static_cast<char>(current_byte_));
-    current_byte_ = 0;
-    num_bits_ = 0;
+    writeFullBytes();
   }
-  // Append the bit to the current byte.
-  current_byte_ <<= 1;
-  current_byte_ |= static_cast<unsigned char>(bit);
-  ++num_bits_;
+}
+
+constexpr std::size_t OBitStream::numBits() const noexcept
+{
+  return size_ * kNumBitsInByte + num_bits_;
 }
 
 constexpr void OBitStream::finalize()
 {
-  if (num_bits_ == 0)
+  if (num_bits_ == 0 && size_ == finalized_size_)
   {
+    // Nothing has been written since the last call.
     return;
   }
-  const unsigned char last_byte = current_byte_ << (kNumBitsInByte - num_bits_);
-  dest_.push_back(static_cast<char>(last_byte));
-  current_byte_ = 0;
-  num_bits_ = 0;
+  writeFullBytes();
+  if (num_bits_ != 0)
+  {
+    putByte(static_cast<unsigned char>(current_bits_ << (kNumBitsInByte - num_bits_)));
+    current_bits_ = 0;
+    num_bits_ = 0;
+  }
+  dest_.resize(size_);
+  finalized_size_ = size_;
+}
+
+constexpr void OBitStream::writeFullBytes()
+{
+  const unsigned int num_bytes = num_bits_ / kNumBitsInByte;
+  if (dest_.size() - size_ < num_bytes)
+  {
+    grow();
+  }
+  // Write via a pointer: std::string::operator[] is much more expensive during constant evaluation.
+  char* out = dest_.data() + size_;
+  for (unsigned int i = 0; i < num_bytes; ++i)
+  {
+    num_bits_ -= kNumBitsInByte;
+    out[i] = static_cast<char>(static_cast<unsigned char>((current_bits_ >> num_bits_) & 0xFF));
+  }
+  current_bits_ &= (std::uint64_t{ 1 } << num_bits_) - 1;
+  size_ += num_bytes;
+}
+
+constexpr void OBitStream::putByte(unsigned char byte)
+{
+  if (size_ == dest_.size())
+  {
+    grow();
+  }
+  dest_[size_] = static_cast<char>(byte);
+  ++size_;
+}
+
+constexpr void OBitStream::grow()
+{
+  // Grow proportionally to the amount of data written since the last finalize(), so that
+  // the total cost of growing remains linear even if finalize() is called frequently.
+  dest_.resize(size_ + std::max(kMinGrowth, size_ - finalized_size_));
 }
 
 }
@@ -0,0 +1,186 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "Exceptions.h"
+#include "RangeCoding.h"
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Byte-oriented range encoder.
+//
+// Just like ArithmeticCoder, RangeCoder allows mutable models, as long as the changes
+// are synchronized during encoding and decoding.
+class RangeCoder
+{
+public:
+  using CodeValue = RangeCodingTraits::CodeValue;
+  using FrequencyCount = RangeCodingTraits::FrequencyCount;
+
+  // Constructs a range coder that appends the encoded bytes to the given string.
+  explicit constexpr RangeCoder(std::string& dest) noexcept;
+
+  // Non-copyable, non-movable.
+  RangeCoder(const RangeCoder&) = delete;
+  RangeCoder(RangeCoder&& other) = delete;
+  RangeCoder& operator=(const RangeCoder&) = delete;
+  RangeCoder& operator=(RangeCoder&& other) = delete;
+
+  // Destructor.
+  //
+  // Calls finalize() under the hood. If finalize() throws any exception, it is suppressed in the destructor.
+  constexpr ~RangeCoder();
+
+  // Encodes the given symbol.
+  // \return the number of bytes shifted out during renormalization. RangeDecoder reads exactly
+  //         as many bytes after decoding this symbol.
+  template<ArithmeticCodingModel Model>
+  constexpr unsigned int encode(const Model& model, typename Model::char_type symbol);
+
+  constexpr unsigned int encode(std::pair<FrequencyCount, FrequencyCount> range, FrequencyCount denominator);
+
+  // Writes the remaining bytes to the output string.
+  //
+  // Only the bytes that are needed to identify the final range are written: the decoder
+  // treats the bytes past the end of the stream as zeros.
+  constexpr void finalize();
+
+private:
+  // Moves the most significant byte of low_ into the cache.
+  constexpr void shiftLow();
+
+  constexpr void putByte(unsigned char byte);
+
+  // The output string for encoded data.
+  std::string* dest_ = nullptr;
+  // Left endpoint of the current range. Bit kCodeValueBits is the carry bit.
+  CodeValue low_ = 0;
+  // Width of the current range.
+  CodeValue range_ = RangeCodingTraits::kTopValue;
+  // The last byte that has been shifted out of low_, but hasn't been written yet,
+  // because it can still be changed by a carry.
+  unsigned char cache_ = 0;
+  // True if cache_ holds a byte.
+  bool has_cache_ = false;
+  // The number of 0xFF bytes following cache_, which haven't been written yet.
+  std::size_t num_pending_bytes_ = 0;
+};
+
+constexpr RangeCoder::RangeCoder(std::string& dest) noexcept:
+  dest_(&dest)
+{
+}
+
+constexpr RangeCoder::~RangeCoder()
+{
+  CTCS_TRY
+  {
+    finalize();
+  }
+  CTCS_CATCH(...)
+  {
+  }
+}
+
+constexpr unsigned int RangeCoder::encode(std::pair<FrequencyCount, FrequencyCount> range,
+                                          FrequencyCount denominator)
+{
+  assert(denominator != 0);
+  assert(range.first < range.second);
+  assert(range.second <= denominator);
+
+  if (!dest_)
+  {
+    CTCS_THROW(std::runtime_error("RangeCoder::encode(): finalize() has already been called."));
+  }
+  // Determine the new subrange.
+  const CodeValue step = range_ / denominator;
+  low_ += step * range.first;
+  range_ = step * (range.second - range.first);
+  // Perform renormalization, if needed.
+  unsigned int num_shifts = 0;
+  while (range_ < RangeCodingTraits::kBottomValue)
+  {
+    range_ <<= 8;
+    shiftLow();
+    ++num_shifts;
+  }
+  return num_shifts;
+}
+
+constexpr void RangeCoder::finalize()
+{
+  if (!dest_)
+  {
+    return;
+  }
+  // Find the number in [low_; low_ + range_) with the largest number of trailing zero bytes.
+  unsigned int num_zero_bytes = RangeCodingTraits::kCodeValueBytes;
+  for (; num_zero_bytes > 0; --num_zero_bytes)
+  {
+    const CodeValue mask = (static_cast<CodeValue>(1) << (num_zero_bytes * 8)) - 1;
+    const CodeValue value = (low_ + mask) & ~mask;
+    if (value - low_ < range_)
+    {
+      low_ = value;
+      break;
+    }
+  }
+  // Shift out the significant bytes. The last call shifts out a zero byte, which
+  // forces the cached bytes to be written; the zero byte itself is discarded.
+  for (unsigned int i = num_zero_bytes; i <= RangeCodingTraits::kCodeValueBytes; ++i)
+  {
+    shiftLow();
+  }
+  dest_ = nullptr;
+}
+
+constexpr void RangeCoder::shiftLow()
+{
+  constexpr unsigned int kTopByteShift = RangeCodingTraits::kCodeValueBits - 8;
+  constexpr CodeValue kTopByteMask = static_cast<CodeValue>(0xFF) << kTopByteShift;
+  constexpr CodeValue kLowBitsMask = (static_cast<CodeValue>(1) << kTopByteShift) - 1;
+
+  const bool has_carry = low_ >= RangeCodingTraits::kTopValue;
+  if (has_carry || (low_ & kTopByteMask) != kTopByteMask)
+  {
+    // The bytes in the cache will not change anymore: write them.
+    const unsigned char carry = has_carry ? 1 : 0;
+    // The first byte is always 0, so it's not written at all.
+    if (has_cache_)
+    {
+      putByte(static_cast<unsigned char>(cache_ + carry));
+    }
+    for (; num_pending_bytes_ > 0; --num_pending_bytes_)
+    {
+      putByte(static_cast<unsigned char>(0xFF + carry));
+    }
+    cache_ = static_cast<unsigned char>((low_ >> kTopByteShift) & 0xFF);
+    has_cache_ = true;
+  }
+  else
+  {
+    // The top byte is 0xFF - it may still change if a carry occurs.
+    ++num_pending_bytes_;
+  }
+  low_ = (low_ & kLowBitsMask) << 8;
+}
+
+constexpr void RangeCoder::putByte(unsigned char byte)
+{
+  dest_->push_back(static_cast<char>(byte));
+}
+
+template<ArithmeticCodingModel Model>
+constexpr unsigned int RangeCoder::encode(const Model& model, typename Model::char_type symbol)
+{
+  return encode(model.getInterval(symbol), model.scalingFactor());
+}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+
+#include <cstdint>
+#include <limits>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Parameters of the byte-oriented range coder.
+//
+// The range coder is a variant of arithmetic coding that performs renormalization
+// a byte at a time (instead of a bit at a time) and propagates carries into the bytes
+// that have already been emitted. It uses the same models as ArithmeticCoder.
+class RangeCodingTraits
+{
+public:
+  // Type of a code value.
+  using CodeValue = std::uint64_t;
+  // Type to store cumulative frequencies.
+  using FrequencyCount = ArithmeticCodingTraits::FrequencyCount;
+  // The number of bytes in a code value.
+  static constexpr unsigned int kCodeValueBytes = 7;
+  // The number of bits in a code value.
+  static constexpr unsigned int kCodeValueBits = kCodeValueBytes * 8;
+  // The initial (and the maximum) width of the range, 2^N.
+  static constexpr CodeValue kTopValue = static_cast<CodeValue>(1) << kCodeValueBits;
+  // Renormalization is performed when the width of the range becomes less than this value, 2^(N-8).
+  static constexpr CodeValue kBottomValue = kTopValue >> 8;
+
+  // Check the constraints:
+  static_assert(kCodeValueBits + 1 <= std::numeric_limits<CodeValue>::digits,
+    "CodeValue must have enough bits to represent all code values and the carry bit.");
+  static_assert(kBottomValue / ArithmeticCodingTraits::kMaxFrequency >= (1 << 16),
+    "The width of the range must remain much greater than the maximum cumulative frequency "
+    "in order to keep the rounding errors negligible.");
+};
+
+}
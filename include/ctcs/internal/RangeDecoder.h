@@ -0,0 +1,92 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "Exceptions.h"
+#include "RangeCoding.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace ctcs::ArithmeticCoding_NS
+{
+
+// Byte-oriented range decoder.
+class RangeDecoder
+{
+public:
+  using CodeValue = RangeCodingTraits::CodeValue;
+  using FrequencyCount = RangeCodingTraits::FrequencyCount;
+
+  // Constructs a decoder for the data encoded by RangeCoder.
+  explicit constexpr RangeDecoder(std::string_view data);
+
+  template<ArithmeticCodingModel Model>
+  constexpr typename Model::char_type decode(const Model& model);
+
+private:
+  constexpr unsigned char readByte();
+
+  // Pointer to the next byte in the stream.
+  const char* stream_ = nullptr;
+  // Pointer past the last byte in the stream.
+  const char* stream_end_ = nullptr;
+  // RangeCoder omits the trailing zero bytes, so we pretend that the stream is padded with zeros.
+  // However, RangeCoder never omits more than a code value, so we track the number of such
+  // "garbage" bytes.
+  std::size_t num_garbage_bytes_ = 0;
+  // Currently-seen code value relative to the left endpoint of the current range.
+  CodeValue code_ = 0;
+  // Width of the current range.
+  CodeValue range_ = RangeCodingTraits::kTopValue;
+};
+
+constexpr RangeDecoder::RangeDecoder(std::string_view data):
+  stream_(data.data()),
+  stream_end_(data.data() + data.size())
+{
+  // Read the first bytes to fill the code value.
+  for (unsigned int i = 0; i < RangeCodingTraits::kCodeValueBytes; ++i)
+  {
+    code_ = (code_ << 8) | readByte();
+  }
+}
+
+template<ArithmeticCodingModel Model>
+constexpr typename Model::char_type RangeDecoder::decode(const Model& model)
+{
+  const FrequencyCount scaling_factor = model.scalingFactor();
+  const CodeValue step = range_ / scaling_factor;
+  // The range may be slightly wider than step * scaling_factor, so clamp the point.
+  const FrequencyCount point = static_cast<FrequencyCount>(
+    std::min<CodeValue>(code_ / step, scaling_factor - 1));
+  const DecodedSymbol<typename Model::char_type> decoded = decodeSymbol(model, point);
+  // Narrow the range to that alloted to this symbol.
+  code_ -= step * decoded.interval.first;
+  range_ = step * (decoded.interval.second - decoded.interval.first);
+  // Perform renormalization, if needed.
+  while (range_ < RangeCodingTraits::kBottomValue)
+  {
+    code_ = (code_ << 8) | readByte();
+    range_ <<= 8;
+  }
+  return decoded.symbol;
+}
+
+constexpr unsigned char RangeDecoder::readByte()
+{
+  if (stream_ != stream_end_)
+  {
+    return static_cast<unsigned char>(*stream_++);
+  }
+  ++num_garbage_bytes_;
+  if (num_garbage_bytes_ > RangeCodingTraits::kCodeValueBytes)
+  {
+    CTCS_THROW(std::logic_error("RangeDecoder: unexpected end of stream."));
+  }
+  return 0;
+}
+
+}
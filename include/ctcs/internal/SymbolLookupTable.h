@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ArithmeticCoding.h"
+#include "CumulativeFrequencySearch.h"
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace ctcs::Detail_NS
+{
+  // Reverse lookup structure for static arithmetic coding models.
+  //
+  // Maps a point from [0; cumulative_frequencies[NumSymbols]) to the index of the symbol, whose
+  // interval contains this point. The range of points is split into at most 2^LogNumBuckets
+  // buckets of equal width, and for each bucket the table stores the index of the symbol that
+  // contains the first point of the bucket. Hence, a lookup only has to search among the symbols
+  // intersecting a single bucket, which for all but the rarest symbols is just 1 or 2 of them;
+  // buckets shared by many rare symbols are searched via CumulativeFrequencySearch.
+  //
+  // The table doesn't store the cumulative frequencies themselves - the caller passes them to find().
+  // \param NumSymbols - the number of symbols in the alphabet.
+  // \param LogNumBuckets - binary logarithm of the maximum number of buckets.
+  template<std::size_t NumSymbols, unsigned int LogNumBuckets = 10>
+  class SymbolLookupTable
+  {
+  public:
+    using FrequencyCount = ArithmeticCoding_NS::ArithmeticCodingTraits::FrequencyCount;
+    using CumulativeFrequencies = std::array<FrequencyCount, NumSymbols + 1>;
+    // Type of a symbol index stored in the table.
+    using Index = std::conditional_t<(NumSymbols <= 256), std::uint8_t, std::uint16_t>;
+
+    static_assert(NumSymbols > 0, "NumSymbols must be positive.");
+    static_assert(NumSymbols <= 65536, "NumSymbols is too big.");
+    static_assert(LogNumBuckets < 24, "LogNumBuckets is too big.");
+
+    // Constructs the lookup table for the given cumulative frequencies.
+    // \param cumulative_frequencies - cumulative frequencies of the symbols.
+    //        cumulative_frequencies[NumSymbols] must be positive.
+    explicit constexpr SymbolLookupTable(const CumulativeFrequencies& cumulative_frequencies) noexcept;
+
+    // Find the symbol whose interval [lower, upper) contains the specified value.
+    // \param cumulative_frequencies - the same cumulative frequencies that were passed to the constructor.
+    // \param value - input point. Must be less than cumulative_frequencies[NumSymbols].
+    // \return index i such that cumulative_frequencies[i] <= value < cumulative_frequencies[i + 1].
+    constexpr std::size_t find(const CumulativeFrequencies& cumulative_frequencies,
+                               FrequencyCount value) const noexcept;
+
+  private:
+    static constexpr std::size_t kMaxNumBuckets = std::size_t{ 1 } << LogNumBuckets;
+
+    // buckets_[i] is the index of the symbol that contains the point (i << shift_).
+    // The last element is a sentinel.
+    std::array<Index, kMaxNumBuckets + 1> buckets_{};
+    // Binary logarithm of the width of a bucket.
+    unsigned int shift_ = 0;
+  };
+
+  template<std::size_t NumSymbols, unsigned int LogNumBuckets>
+  constexpr SymbolLookupTable<NumSymbols, LogNumBuckets>::SymbolLookupTable(
+    const CumulativeFrequencies& cumulative_frequencies) noexcept
+  {
+    const FrequencyCount total = cumulative_frequencies[NumSymbols];
+    const unsigned int num_bits = static_cast<unsigned int>(std::bit_width(total - 1));
+    shift_ = (num_bits > LogNumBuckets) ? (num_bits - LogNumBuckets) : 0;
+    std::size_t symbol = 0;
+    for (std::size_t i = 0; i <= kMaxNumBuckets; ++i)
+    {
+      const std::uint64_t point = static_cast<std::uint64_t>(i) << shift_;
+      if (point >= total)
+      {
+        buckets_[i] = static_cast<Index>(NumSymbols - 1);
+        continue;
+      }
+      // The points are increasing, so we can continue from the previous symbol.
+      while (cumulative_frequencies[symbol + 1] <= point)
+      {
+        ++symbol;
+      }
+      buckets_[i] = static_cast<Index>(symbol);
+    }
+  }
+
+  template<std::size_t NumSymbols, unsigned int LogNumBuckets>
+  constexpr std::size_t SymbolLookupTable<NumSymbols, LogNumBuckets>::find(
+    const CumulativeFrequencies& cumulative_frequencies, FrequencyCount value) const noexcept
+  {
+    const std::size_t bucket = static_cast<std::size_t>(value >> shift_);
+    // The answer is within [first; last].
+    const std::size_t first = buckets_[bucket];
+    const std::size_t last = buckets_[bucket + 1];
+    if (first == last)
+    {
+      return first;
+    }
+    if (last - first > CumulativeFrequencySearch::kBlockSize) [[unlikely]]
+    {
+      // Rare symbols can share a bucket with dozens of others.
+      return first + CumulativeFrequencySearch::find(
+        std::span<const FrequencyCount>(cumulative_frequencies.data() + first, last - first + 2), value);
+    }
+    // Usually, there are just 1 or 2 candidates.
+    std::size_t index = first;
+    while (cumulative_frequencies[index + 1] <= value)
+    {
+      ++index;
+    }
+    return index;
+  }
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include "Exceptions.h"
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace ctcs::Detail_NS
+{
+  // The largest Unicode code point.
+  inline constexpr char32_t kMaxCodePoint = 0x10FFFF;
+
+  // \return true if CharT is a UTF-16 code unit type: char16_t, or wchar_t on platforms where it is 16-bit.
+  template<class CharT>
+  inline constexpr bool kIsUtf16CodeUnit =
+    std::is_same_v<CharT, char16_t> || (std::is_same_v<CharT, wchar_t> && sizeof(wchar_t) == 2);
+
+  // \return true if CharT is a UTF-32 code unit type: char32_t, or wchar_t on platforms where it is 32-bit.
+  template<class CharT>
+  inline constexpr bool kIsUtf32CodeUnit =
+    std::is_same_v<CharT, char32_t> || (std::is_same_v<CharT, wchar_t> && sizeof(wchar_t) == 4);
+
+  // \return true if the given code point is a UTF-16 surrogate.
+  constexpr bool isSurrogate(char32_t code_point) noexcept
+  {
+    return code_point >= 0xD800 && code_point <= 0xDFFF;
+  }
+
+  // Appends the UTF-8 representation of the given code point to the string.
+  // \throw std::invalid_argument if the code point is a surrogate or exceeds kMaxCodePoint.
+  constexpr void appendUtf8(std::string& dest, char32_t code_point)
+  {
+    if (code_point > kMaxCodePoint || isSurrogate(code_point))
+    {
+      CTCS_THROW(std::invalid_argument("appendUtf8(): invalid code point."));
+    }
+    if (code_point < 0x80)
+    {
+      dest.push_back(static_cast<char>(code_point));
+    }
+    else if (code_point < 0x800)
+    {
+      dest.push_back(static_cast<char>(0xC0 | (code_point >> 6)));
+      dest.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else if (code_point < 0x10000)
+    {
+      dest.push_back(static_cast<char>(0xE0 | (code_point >> 12)));
+      dest.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      dest.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+    else
+    {
+      dest.push_back(static_cast<char>(0xF0 | (code_point >> 18)));
+      dest.push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3F)));
+      dest.push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3F)));
+      dest.push_back(static_cast<char>(0x80 | (code_point & 0x3F)));
+    }
+  }
+
+  // Converts the given string into UTF-8.
+  //
+  // char8_t strings are copied as is; char16_t strings are treated as UTF-16, and char32_t strings
+  // as UTF-32. wchar_t strings are treated as either UTF-16 or UTF-32, depending on the size of wchar_t.
+  // \param str - input string.
+  // \return UTF-8 representation of the string.
+  // \throw std::invalid_argument if the string is not a valid UTF-16/UTF-32 string.
+  template<class CharT>
+  constexpr std::string toUtf8(std::basic_string_view<CharT> str)
+  {
+    std::string result;
+    if constexpr (std::is_same_v<CharT, char8_t>)
+    {
+      result.reserve(str.size());
+      for (char8_t c : str)
+      {
+        result.push_back(static_cast<char>(c));
+      }
+    }
+    else if constexpr (kIsUtf16CodeUnit<CharT>)
+    {
+      for (std::size_t i = 0; i < str.size(); ++i)
+      {
+        char32_t code_point = static_cast<char16_t>(str[i]);
+        if (code_point >= 0xD800 && code_point <= 0xDBFF)
+        {
+          // High surrogate: must be followed by a low one.
+          const char32_t low = (i + 1 < str.size()) ? static_cast<char16_t>(str[i + 1]) : 0;
+          if (low < 0xDC00 || low > 0xDFFF)
+          {
+            CTCS_THROW(std::invalid_argument("toUtf8(): unpaired surrogate."));
+          }
+          code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+          ++i;
+        }
+        appendUtf8(result, code_point);
+      }
+    }
+    else
+    {
+      static_assert(kIsUtf32CodeUnit<CharT>, "Unsupported character type.");
+      for (CharT c : str)
+      {
+        appendUtf8(result, static_cast<char32_t>(c));
+      }
+    }
+    return result;
+  }
+
+  // Incremental UTF-8 decoder, which converts UTF-8 into UTF-16 or UTF-32 code units one byte at a time.
+  // \param CharT - code unit type: char16_t, char32_t or wchar_t.
+  // \param Checked - if false, the input is trusted to be valid UTF-8, and isn't validated.
+  template<class CharT, bool Checked = true>
+  class Utf8Decoder
+  {
+  public:
+    static_assert(kIsUtf16CodeUnit<CharT> || kIsUtf32CodeUnit<CharT>, "Unsupported character type.");
+
+    // Code units produced by push().
+    struct Output
+    {
+      std::array<CharT, 2> code_units;
+      // The number of code units; 0 if the current sequence is incomplete.
+      std::size_t size;
+    };
+
+    // Feeds the next byte to the decoder.
+    // \return the code units for the code point completed by this byte, if any.
+    // \throw std::runtime_error if Checked is true and the byte sequence is not valid UTF-8.
+    constexpr Output push(char byte);
+
+    // \return true if the decoder is not in the middle of a multi-byte sequence.
+    constexpr bool complete() const noexcept
+    {
+      return num_remaining_bytes_ == 0;
+    }
+
+  private:
+    // The bits of the current code point decoded so far.
+    char32_t code_point_ = 0;
+    // The number of continuation bytes expected until the end of the current code point.
+    unsigned int num_remaining_bytes_ = 0;
+    // The smallest code point that can be encoded with the current number of bytes, to reject overlong sequences.
+    char32_t min_code_point_ = 0;
+  };
+
+  template<class CharT, bool Checked>
+  constexpr typename Utf8Decoder<CharT, Checked>::Output Utf8Decoder<CharT, Checked>::push(char byte)
+  {
+    const unsigned char value = static_cast<unsigned char>(byte);
+    if (num_remaining_bytes_ == 0)
+    {
+      if (value < 0x80)
+      {
+        return { { static_cast<CharT>(value), CharT{} }, 1 };
+      }
+      if (value >= 0xC2 && value <= 0xDF)
+      {
+        code_point_ = value & 0x1F;
+        num_remaining_bytes_ = 1;
+        min_code_point_ = 0x80;
+      }
+      else if (value >= 0xE0 && value <= 0xEF)
+      {
+        code_point_ = value & 0x0F;
+        num_remaining_bytes_ = 2;
+        min_code_point_ = 0x800;
+      }
+      else if (value >= 0xF0 && value <= 0xF4)
+      {
+        code_point_ = value & 0x07;
+        num_remaining_bytes_ = 3;
+        min_code_point_ = 0x10000;
+      }
+      else if constexpr (Checked)
+      {
+        CTCS_THROW(std::runtime_error("Utf8Decoder: invalid UTF-8 sequence."));
+      }
+      return { {}, 0 };
+    }
+    if constexpr (Checked)
+    {
+      if ((value & 0xC0) != 0x80)
+      {
+        CTCS_THROW(std::runtime_error("Utf8Decoder: invalid UTF-8 sequence."));
+      }
+    }
+    code_point_ = (code_point_ << 6) | (value & 0x3F);
+    if (--num_remaining_bytes_ != 0)
+    {
+      return { {}, 0 };
+    }
+    if constexpr (Checked)
+    {
+      if (code_point_ < min_code_point_ || code_point_ > kMaxCodePoint || isSurrogate(code_point_))
+      {
+        CTCS_THROW(std::runtime_error("Utf8Decoder: invalid UTF-8 sequence."));
+      }
+    }
+    if constexpr (kIsUtf16CodeUnit<CharT>)
+    {
+      if (code_point_ >= 0x10000)
+      {
+        const char32_t offset = code_point_ - 0x10000;
+        return { { static_cast<CharT>(0xD800 + (offset >> 10)), static_cast<CharT>(0xDC00 + (offset & 0x3FF)) }, 2 };
+      }
+    }
+    return { { static_cast<CharT>(code_point_), CharT{} }, 1 };
+  }
+}
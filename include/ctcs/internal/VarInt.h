@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace ctcs::Detail_NS
 {
@@ -42,10 +44,12 @@ namespace ctcs::Detail_NS
   };
 
   // Deserializes a VarInt from the input string.
+  // \param Checked - if false, the input is trusted to contain a valid VarInt, and isn't bounds-checked.
   // \param data - input string.
   // \return the deserialized integer and the number of consumed bytes.
   // \throw std::out_of_range if failed to deserialize the input data as VarInt
   //        (i.e. if the terminal byte is missing from @data).
+  template<bool Checked = true>
   constexpr ReadVarIntResult readVarInt(std::string_view data)
   {
     // The number of bits in a byte of a VarInt.
@@ -64,7 +68,7 @@ namespace ctcs::Detail_NS
     do
     {
       // Read a single "byte" of a VarInt.
-      const unsigned char bits = data.at(num_bytes_read);
+      const unsigned char bits = Checked ? data.at(num_bytes_read) : data[num_bytes_read];
       ++num_bytes_read;
       // Check the sentinel bit, which tells if there are more bytes to read.
       has_more_bytes = bits & kSentinelBitMask;
@@ -0,0 +1,28 @@
+// The headers included below are generated at build time by ctcs_add_compressed_resource().
+#include "greeting.h"
+#include "license.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <type_traits>
+
+namespace
+{
+  // ctcs_pack produces exactly the same object as ctcs::compress() for the same contents.
+  constexpr auto kGreetingCompressed = ctcs::compress<"Hello, World!">();
+  static_assert(std::is_same_v<decltype(kGreetingCompressed), decltype(ctcs_test::kGreeting)>);
+  static_assert(ctcs_test::kGreeting.compressedData().view() == kGreetingCompressed.compressedData().view());
+  static_assert(ctcs_test::kGreeting.decompress() == "Hello, World!");
+}
+
+int main()
+{
+  std::ifstream license_file(CTCS_TEST_LICENSE_PATH, std::ios::binary);
+  const std::string license(std::istreambuf_iterator<char>(license_file), {});
+  if (license.empty() || ctcs_test::kLicense.decompress() != license)
+  {
+    return 1;
+  }
+  return 0;
+}
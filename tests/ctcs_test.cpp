@@ -1,6 +1,16 @@
 #include <ctcs/ctcs.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
 
 // Any decent compiler will detect that the built-in string literals in this file
 // are not used at runtime, and will compile them out.
@@ -16,6 +26,220 @@ namespace
   static_assert(kHelloWorldCompressed.decompress() == "Hello, World!",
     "If Decompressor is constexpr, then you can even verify at compile time "
     "that the decompressed string equals the original one.");
+
+  // Compression statistics are available at compile time.
+  static_assert(kHelloWorldCompressed.kCompressedSize == 11);
+  static_assert(kHelloWorldCompressed.kCompressionRatio == 13.0 / 11.0);
+  static_assert(kHelloWorldCompressed.kBitsPerChar == 88.0 / 13.0);
+
+  // DecodeObserver, which counts the runtime decompressions.
+  struct CountingObserver
+  {
+    static void onDecode(const ctcs::DecodeEvent& event)
+    {
+      ++num_decodes;
+      num_bytes += event.decompressed_data.size();
+    }
+
+    static inline std::size_t num_decodes = 0;
+    static inline std::size_t num_bytes = 0;
+  };
+
+  constexpr auto kHelloWorldObserved =
+    ctcs::compress<"Hello, World!", ctcs::ArithmeticCodingCompressor<ctcs::EnglishCharModel>, CountingObserver>();
+  static_assert(sizeof(kHelloWorldObserved) == sizeof(kHelloWorldCompressed));
+  static_assert(kHelloWorldObserved.decompress() == "Hello, World!");
+
+  // EnglishCharModel assumes that non-ASCII bytes almost never occur, so non-English UTF-8 text grows.
+  // Utf8Model follows the structure of UTF-8, and shrinks it.
+  constexpr ctcs::StringLiteral kRussianUtf8 = "Файл не найден. Хотите продолжить?";
+  static_assert(ctcs::compress<kRussianUtf8>().kCompressedSize > kRussianUtf8.size());
+  constexpr auto kRussianCompressed = ctcs::compress<kRussianUtf8, ctcs::ArithmeticCodingCompressor<ctcs::Utf8Model<>>>();
+  static_assert(kRussianCompressed.kCompressedSize < kRussianUtf8.size() * 3 / 4);
+  static_assert(kRussianCompressed.decompress() == kRussianUtf8.view());
+
+  // Literals of other character types are converted into UTF-8 and compressed with Utf8Model by default.
+  constexpr auto kJapaneseUtf16 = ctcs::compress<u"ファイルが見つかりません。">();
+  static_assert(std::is_same_v<decltype(kJapaneseUtf16)::char_type, char16_t>);
+  static_assert(kJapaneseUtf16.kCompressedSize < std::u8string_view(u8"ファイルが見つかりません。").size());
+  static_assert(kJapaneseUtf16.decompress() == u"ファイルが見つかりません。");
+  constexpr auto kGermanUtf8 = ctcs::compress<u8"Schließen">();
+  static_assert(kGermanUtf8.decompress() == u8"Schließen");
+  constexpr auto kEmojiUtf32 = ctcs::compress<U"\U0001F600 Привет">();
+  static_assert(kEmojiUtf32.decompress() == U"\U0001F600 Привет");
+  constexpr auto kEmojiWide = ctcs::compress<L"\U0001F600 Привет">();
+  static_assert(kEmojiWide.decompress() == L"\U0001F600 Привет");
+
+  // Binary data: std::array of unsigned char or std::byte, e.g. a gamma correction table.
+  constexpr std::array<unsigned char, 256> kGammaTable = []()
+  {
+    std::array<unsigned char, 256> table{};
+    for (std::size_t i = 0; i < table.size(); ++i)
+    {
+      table[i] = static_cast<unsigned char>(i * i / 255);
+    }
+    return table;
+  }();
+  constexpr auto kGammaTableCompressed = ctcs::compress<kGammaTable>();
+  static_assert(kGammaTableCompressed.kCompressedSize < kGammaTable.size() / 4);
+  static_assert(kGammaTableCompressed.decompressToArray() == kGammaTable);
+  // Data that doesn't compress is stored with a 1-byte header.
+  constexpr std::array<std::byte, 5> kBytes = { std::byte{ 0xDE }, std::byte{ 0xAD }, std::byte{ 0xBE },
+                                                std::byte{ 0xEF }, std::byte{ 0x00 } };
+  constexpr auto kBytesCompressed = ctcs::compress<kBytes>();
+  static_assert(kBytesCompressed.kCompressedSize == kBytes.size() + 1);
+  static_assert(kBytesCompressed.decompressToArray() == kBytes);
+
+  // CumulativeFrequencySearch finds the symbol that contains a point; empty intervals are skipped.
+  constexpr std::array<std::uint32_t, 6> kCumulativeFrequencies = { 0, 3, 3, 4, 10, 11 };
+  static_assert(ctcs::Detail_NS::CumulativeFrequencySearch::find(kCumulativeFrequencies, 2) == 0);
+  static_assert(ctcs::Detail_NS::CumulativeFrequencySearch::find(kCumulativeFrequencies, 3) == 2);
+  static_assert(ctcs::Detail_NS::CumulativeFrequencySearch::find(kCumulativeFrequencies, 10) == 4);
+
+  // The compressor normally runs once at compile time; strings that don't compress well still work.
+  constexpr auto kIncompressible = ctcs::compress<"\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f">();
+  static_assert(kIncompressible.compressedData().size() > ctcs::Detail_NS::guessCompressedCapacity(16));
+  static_assert(kIncompressible.decompress() == "\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f\x7f");
+
+  // RangeCodingCompressor uses the same models, but renormalizes a byte at a time.
+  constexpr ctcs::CompressedString kHelloWorldRangeCoded =
+    ctcs::compress<"Hello, World!", ctcs::RangeCodingCompressor<ctcs::EnglishCharModel>>();
+  static_assert(sizeof(kHelloWorldRangeCoded) == 11);
+  static_assert(kHelloWorldRangeCoded.decompress() == "Hello, World!");
+
+  // InterleavedRangeCodingCompressor splits the symbols among several range coder states.
+  // Each extra state costs up to 7 bytes; with a single state the output is the same as above.
+  constexpr ctcs::CompressedString kHelloWorldInterleaved =
+    ctcs::compress<"Hello, World!", ctcs::InterleavedRangeCodingCompressor<ctcs::EnglishCharModel, 4>>();
+  static_assert(sizeof(kHelloWorldInterleaved) <= sizeof(kHelloWorldRangeCoded) + 3 * 7);
+  static_assert(sizeof(ctcs::compress<"Hello, World!", ctcs::InterleavedRangeCodingCompressor<ctcs::EnglishCharModel, 1>>()) ==
+                sizeof(kHelloWorldRangeCoded));
+  static_assert(kHelloWorldInterleaved.decompress() == "Hello, World!");
+
+  // HuffmanCompressor trades a little compression ratio for much faster decompression.
+  constexpr ctcs::CompressedString kHelloWorldHuffman = ctcs::compress<"Hello, World!", ctcs::HuffmanCompressor<>>();
+  static_assert(sizeof(kHelloWorldHuffman) == 11);
+  static_assert(kHelloWorldHuffman.decompress() == "Hello, World!");
+
+  // Decompression streams decode the data a few characters at a time.
+  static_assert(std::input_iterator<decltype(kHelloWorldHuffman.stream().begin())>);
+  static_assert([]()
+  {
+    std::string result;
+    for (char c : kHelloWorldHuffman.stream())
+    {
+      result.push_back(c);
+    }
+    return result;
+  }() == "Hello, World!");
+
+  constexpr ctcs::StringLiteral kJsonLog =
+    "{\"level\":\"info\",\"ts\":1700000000,\"msg\":\"request completed\",\"status\":200}\n"
+    "{\"level\":\"info\",\"ts\":1700000001,\"msg\":\"request completed\",\"status\":200}\n"
+    "{\"level\":\"warn\",\"ts\":1700000002,\"msg\":\"request failed\",\"status\":503}\n";
+
+  // AdaptiveCharModel learns the distribution of the characters as it goes, so it works
+  // better than EnglishCharModel for text that doesn't look like English prose.
+  constexpr ctcs::CompressedString kJsonLogEnglish = ctcs::compress<kJsonLog>();
+  constexpr ctcs::CompressedString kJsonLogAdaptive =
+    ctcs::compress<kJsonLog, ctcs::ArithmeticCodingCompressor<ctcs::AdaptiveCharModel>>();
+  static_assert(sizeof(kJsonLogEnglish) == 260);
+  static_assert(sizeof(kJsonLogAdaptive) == 142);
+  static_assert(kJsonLogAdaptive.decompress() == kJsonLog.view());
+
+  // ContextModel conditions on the previous 1 or 2 characters.
+  constexpr ctcs::CompressedString kJsonLogOrder2 =
+    ctcs::compress<kJsonLog, ctcs::ArithmeticCodingCompressor<ctcs::ContextModel<2>>>();
+  static_assert(sizeof(kJsonLogOrder2) == 97);
+  static_assert(kJsonLogOrder2.decompress() == kJsonLog.view());
+
+  // TrainedCharModel computes the distribution of characters from the given samples at compile time.
+  using JsonLogCharModel = ctcs::TrainedCharModel<kJsonLog>;
+  constexpr ctcs::CompressedString kJsonLogTrained = ctcs::compress<
+    "{\"level\":\"error\",\"ts\":1700000003,\"msg\":\"request timed out\",\"status\":504}\n",
+    ctcs::ArithmeticCodingCompressor<JsonLogCharModel>>();
+  static_assert(sizeof(kJsonLogTrained) == 43);
+  static_assert(kJsonLogTrained.decompress() ==
+    "{\"level\":\"error\",\"ts\":1700000003,\"msg\":\"request timed out\",\"status\":504}\n");
+
+  // LzCompressor replaces repeated fragments with references to their previous occurrences.
+  constexpr ctcs::StringLiteral kAllWorkAndNoPlay =
+    "All work and no play makes Jack a dull boy\n"
+    "All work and no play makes Jack a dull boy\n"
+    "All work and no play makes Jack a dull boy\n"
+    "All work and no play makes Jack a dull boy\n"
+    "All work and no play makes Jack a dull boy\n";
+  constexpr ctcs::CompressedString kAllWorkAndNoPlayLz = ctcs::compress<kAllWorkAndNoPlay, ctcs::LzCompressor<>>();
+  static_assert(sizeof(kAllWorkAndNoPlayLz) == 33);
+  static_assert(kAllWorkAndNoPlayLz.decompress() == kAllWorkAndNoPlay.view());
+  constexpr ctcs::CompressedString kJsonLogLz = ctcs::compress<kJsonLog, ctcs::LzCompressor<>>();
+  static_assert(sizeof(kJsonLogLz) == 99);
+  static_assert(kJsonLogLz.decompress() == kJsonLog.view());
+
+  // CompressedStringTable packs many strings into a single blob, and decompresses them individually.
+  constexpr auto kErrorMessages = ctcs::compressTable<
+    "File not found.",
+    "",
+    "Permission denied.",
+    "The operation timed out.",
+    "Connection refused by the remote host.">();
+  static_assert(kErrorMessages.size() == 5);
+  static_assert(sizeof(kErrorMessages.compressedData()) == 54);
+  static_assert(sizeof(kErrorMessages) == 64);
+  static_assert(kErrorMessages.get(0) == "File not found.");
+  static_assert(kErrorMessages.get(1).empty());
+  static_assert(kErrorMessages.get(4) == "Connection refused by the remote host.");
+
+  // BlockCompressedString decodes only the blocks that overlap with the requested substring.
+  constexpr auto kPoemBlocks = ctcs::compressBlocks<
+    "Tyger Tyger, burning bright,\n"
+    "In the forests of the night;\n"
+    "What immortal hand or eye,\n"
+    "Could frame thy fearful symmetry?", ctcs::EnglishCharModel, 16>();
+  static_assert(kPoemBlocks.kNumBlocks == 8);
+  static_assert(kPoemBlocks.numLines() == 4);
+  static_assert(kPoemBlocks.line(1) == "In the forests of the night;");
+  static_assert(kPoemBlocks.line(3) == "Could frame thy fearful symmetry?");
+  static_assert(kPoemBlocks.substr(6, 15) == "Tyger, burning ");
+  static_assert(kPoemBlocks.at(29) == 'I');
+  static_assert(kPoemBlocks.decompress().ends_with("symmetry?"));
+
+  // CompressedString decompresses the data produced by ctcs::compress() without validating it.
+  static_assert(ctcs::Detail_NS::TrustedDecompressor<ctcs::ArithmeticCodingDecompressor<ctcs::EnglishCharModel>, char>);
+  static_assert(!ctcs::Detail_NS::TrustedDecompressor<ctcs::HuffmanDecompressor<ctcs::EnglishCharModel>, char>);
+  static_assert(ctcs::Detail_NS::TrustedDecompressor<
+    ctcs::UnicodeDecompressor<char16_t, ctcs::ArithmeticCodingDecompressor<ctcs::Utf8Model<>>>, char16_t>);
+  // The built-in models skip the validation of the decoded point with TrustedDecode.
+  static_assert(ctcs::ArithmeticCoding_NS::PolicyAwareArithmeticCodingModel<ctcs::EnglishCharModel, ctcs::TrustedDecode>);
+  static_assert(ctcs::ArithmeticCoding_NS::PolicyAwareArithmeticCodingModel<ctcs::ContextModel<2>, ctcs::TrustedDecode>);
+  static_assert(ctcs::ArithmeticCoding_NS::PolicyAwareArithmeticCodingModel<ctcs::Utf8Model<>, ctcs::TrustedDecode>);
+  static_assert(ctcs::EnglishCharModel{}.decodeSymbol(100, ctcs::TrustedDecode{}).symbol ==
+                ctcs::EnglishCharModel{}.decodeSymbol(100).symbol);
+
+  // Checks that ArithmeticCodingRuntimeCompressor<Model> produces the same data as ArithmeticCodingCompressor<Model>.
+  // A single runtime compressor is used for all inputs, so the model is reset between them.
+  template<class Model>
+  bool runtimeCompressorMatches(const std::vector<std::string>& inputs)
+  {
+    ctcs::ArithmeticCodingRuntimeCompressor<Model> runtime_compressor;
+    std::string dest = "header";
+    for (const std::string& input : inputs)
+    {
+      const std::string expected = ctcs::ArithmeticCodingCompressor<Model>{}(input);
+      if (runtime_compressor.compress(input) != expected)
+      {
+        return false;
+      }
+      // compress(data, dest) appends to dest.
+      const std::size_t offset = dest.size();
+      runtime_compressor.compress(input, dest);
+      if (std::string_view(dest).substr(offset) != expected)
+      {
+        return false;
+      }
+    }
+    return true;
+  }
 }
 
 int main()
@@ -26,6 +250,137 @@ int main()
   // CompressedString is implicitly convertible to std::string - the result is the decompressed string.
   std::string hello_world2 = ctcs::compress<"Hello, World!">();
 
+  // The size of the decompressed string is known at compile time, so it can be decompressed
+  // into a buffer on the stack.
+  static_assert(kHelloWorldCompressed.kDecompressedSize == 13);
+  static_assert(std::string_view(kHelloWorldCompressed.decompressToArray().data(), 13) == "Hello, World!");
+  char hello_world_buffer[decltype(kHelloWorldCompressed)::kDecompressedSize];
+  kHelloWorldCompressed.decompressInto(hello_world_buffer);
+
+  // The observer is notified about every runtime decompression.
+  if (kHelloWorldObserved.decompress() != "Hello, World!" || std::string(kHelloWorldObserved) != "Hello, World!" ||
+      CountingObserver::num_decodes != 2 || CountingObserver::num_bytes != 26)
+  {
+    return 1;
+  }
+
+  // DecodeProfiler aggregates the decompressions of each string.
+  constexpr auto kProfiledString =
+    ctcs::compress<"Goodbye, World!", ctcs::ArithmeticCodingCompressor<ctcs::EnglishCharModel>, ctcs::DecodeProfiler>();
+  kProfiledString.decompress();
+  kProfiledString.decompress();
+  const std::vector<ctcs::DecodeProfiler::Entry> profile = ctcs::DecodeProfiler::entries();
+  if (profile.size() != 1 || profile[0].text != "Goodbye, World!" || profile[0].num_decodes != 2 ||
+      profile[0].num_bytes != 30 || profile[0].compressed_size != kProfiledString.kCompressedSize)
+  {
+    return 1;
+  }
+
+  // Non-char strings can be decompressed lazily as well.
+  if (ctcs::lazy<u"Привет">() != u"Привет")
+  {
+    return 1;
+  }
+
+  // Block-compressed strings can be decompressed on several threads.
+  std::string poem(kPoemBlocks.size(), '\0');
+  ctcs::decompressParallel(kPoemBlocks, poem, 4);
+  std::string poem2(kPoemBlocks.size(), '\0');
+  ctcs::decompressParallel(kPoemBlocks, poem2, [](std::function<void()> task) { task(); }, 4);
+  if (poem != kPoemBlocks.decompress() || poem2 != poem)
+  {
+    return 1;
+  }
+
+  // ctcs::lazy() decompresses the string once, and returns the same view on every call.
+  const std::string_view hello_world_lazy = ctcs::lazy<"Hello, World!">();
+  if (hello_world_lazy != "Hello, World!" || ctcs::lazy<"Hello, World!">().data() != hello_world_lazy.data())
+  {
+    return 1;
+  }
+
+  // ctcs::prewarm() decompresses the strings registered via ctcs::prewarmed() ahead of time.
+  const ctcs::PrewarmStats prewarm_stats = ctcs::prewarm(2);
+  const ctcs::PrewarmStats prewarm_stats2 = ctcs::prewarm([](std::function<void()> task) { task(); });
+  if (prewarm_stats.num_strings != 2 || prewarm_stats.num_bytes != 28 || prewarm_stats2.num_strings != 0 ||
+      ctcs::prewarmed<"Goodbye, World!">() != "Goodbye, World!" || ctcs::prewarmed<"See you later">() != "See you later")
+  {
+    return 1;
+  }
+
+  // Strings compressed at runtime use the same format as the ones compressed at compile time.
+  ctcs::ArithmeticCodingRuntimeCompressor<ctcs::EnglishCharModel> runtime_compressor;
+  ctcs::ArithmeticCodingRuntimeCompressor<ctcs::AdaptiveCharModel> runtime_adaptive_compressor;
+  std::string poem_compressed;
+  runtime_adaptive_compressor.compress(poem, poem_compressed);
+  std::string poem_decompressed;
+  ctcs::ArithmeticCodingDecompressor<ctcs::AdaptiveCharModel>{}(poem_compressed, poem_decompressed);
+  // Data compressed at runtime can be decompressed without validation once it's known to be valid.
+  std::string poem_trusted(poem.size(), '\0');
+  ctcs::ArithmeticCodingDecompressor<ctcs::AdaptiveCharModel>{}(poem_compressed, poem_trusted, ctcs::TrustedDecode{});
+  if (runtime_compressor.compress("Hello, World!") != kHelloWorldCompressed.compressedData().view() ||
+      poem_trusted != poem ||
+      runtime_compressor.compress("") != "" || poem_decompressed != poem ||
+      poem_compressed != ctcs::ArithmeticCodingCompressor<ctcs::AdaptiveCharModel>{}(poem))
+  {
+    return 1;
+  }
+  // Inputs that the encoder doesn't see in text: long runs of a single character (which may
+  // underflow for more than 32 bits in a row), skewed and random bytes (which take more space
+  // than the initial estimate, so the buffer has to grow).
+  std::uint32_t seed = 1;
+  const auto next_random = [&seed]()
+  {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 16;
+  };
+  std::string runs;
+  std::string skewed;
+  std::string random_bytes;
+  for (int i = 0; i < 200; ++i)
+  {
+    runs.append(100 + next_random() % 400, 'e');
+    runs.push_back(static_cast<char>(next_random()));
+  }
+  for (int i = 0; i < 20000; ++i)
+  {
+    skewed.push_back((next_random() % 64 == 0) ? 'z' : 'e');
+    random_bytes.push_back(static_cast<char>(next_random()));
+  }
+  const std::vector<std::string> runtime_inputs = { runs, skewed, random_bytes, poem, runs.substr(0, 1000) };
+  if (!runtimeCompressorMatches<ctcs::EnglishCharModel>(runtime_inputs) ||
+      !runtimeCompressorMatches<ctcs::AdaptiveCharModel>(runtime_inputs) ||
+      !runtimeCompressorMatches<ctcs::ContextModel<1>>(runtime_inputs) ||
+      !runtimeCompressorMatches<ctcs::ContextModel<2>>(runtime_inputs) ||
+      !runtimeCompressorMatches<ctcs::Utf8Model<>>(runtime_inputs))
+  {
+    return 1;
+  }
+
+  // The vectorized search finds the same symbols as the one used during constant evaluation.
+  std::vector<std::uint32_t> cumulative_frequencies(1, 0);
+  for (std::uint32_t i = 0; i < 300; ++i)
+  {
+    cumulative_frequencies.push_back(cumulative_frequencies.back() + (i * 7919) % 5);
+    for (std::uint32_t value = 0; value < cumulative_frequencies.back(); ++value)
+    {
+      const std::size_t expected = static_cast<std::size_t>(
+        std::upper_bound(cumulative_frequencies.begin(), cumulative_frequencies.end(), value) -
+        cumulative_frequencies.begin()) - 1;
+      if (ctcs::Detail_NS::CumulativeFrequencySearch::find(cumulative_frequencies, value) != expected)
+      {
+        return 1;
+      }
+    }
+  }
+
+  // Binary data is decompressed into std::vector.
+  const std::vector<unsigned char> gamma_table = kGammaTableCompressed.decompress();
+  if (!std::equal(gamma_table.begin(), gamma_table.end(), kGammaTable.begin(), kGammaTable.end()))
+  {
+    return 1;
+  }
+
   // Compress an empty string, brilliant.
   constexpr ctcs::CompressedString kEmptyString = ctcs::compress<"">();
   static_assert(kEmptyString.decompress().empty());
@@ -61,6 +416,20 @@ int main()
 
   // Decompress at runtime.
   static const std::string shadow_over_innsmouth = kShadowOverInnsmouthCompressed.decompress();
+
+  // Large strings can be decompressed in chunks of bounded size.
+  auto shadow_over_innsmouth_stream = kShadowOverInnsmouthCompressed.stream();
+  char chunk[64];
+  std::string shadow_over_innsmouth_streamed;
+  while (!shadow_over_innsmouth_stream.done())
+  {
+    const std::size_t num_chars = shadow_over_innsmouth_stream.read(chunk);
+    shadow_over_innsmouth_streamed.append(chunk, num_chars);
+  }
+  if (shadow_over_innsmouth_streamed != shadow_over_innsmouth)
+  {
+    return 1;
+  }
   std::cout << shadow_over_innsmouth << std::endl;
   return 0;
 }
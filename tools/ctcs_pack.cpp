@@ -0,0 +1,292 @@
+// Build-time compression tool.
+//
+// Compresses a file with one of the compressors from the library at native speed, and generates
+// a header that defines a ready-made CompressedString (or CompressedBytes) object. The compressed
+// data is exactly the same as the one produced by ctcs::compress() for the same contents, so large
+// resources can be compressed without constant evaluation.
+//
+// Usage:
+//   ctcs_pack --input FILE --output HEADER --name IDENTIFIER [--namespace NAMESPACE]
+//             [--compressor NAME] [--binary]
+//   ctcs_pack --list-compressors
+//
+// By default, the file is compressed like ctcs::compress<"...">() does, and the generated object is a
+// CompressedString. With --binary, the object is a CompressedBytes of unsigned char, compressed like
+// ctcs::compress<std::array<unsigned char, N>{...}>() does.
+//
+// Usually, this tool is invoked via the CMake function ctcs_add_compressed_resource().
+#include <ctcs/ctcs.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace
+{
+  // A compressor that can be chosen via --compressor.
+  struct CompressorInfo
+  {
+    // The name of the compressor on the command line.
+    const char* name;
+    // The name of the compressor class, as it should be spelled in the generated header.
+    const char* type_name;
+    // Compresses the given data.
+    std::string (*compress)(std::string_view data);
+    // Decompresses the given data into a buffer of the given size.
+    std::string (*decompress)(std::string_view compressed_data, std::size_t size);
+  };
+
+  template<class Compressor>
+  std::string compressWith(std::string_view data)
+  {
+    return Compressor{}(data);
+  }
+
+  template<class Compressor>
+  std::string decompressWith(std::string_view compressed_data, std::size_t size)
+  {
+    std::string result(size, '\0');
+    result.resize(typename Compressor::Decompressor{}(compressed_data, std::span<char>(result)));
+    return result;
+  }
+
+#define CTCS_PACK_COMPRESSOR(name, ...) \
+  CompressorInfo{ name, #__VA_ARGS__, &compressWith<__VA_ARGS__>, &decompressWith<__VA_ARGS__> }
+
+  // The first compressor is the default one for text, the last one is the default one for binary data.
+  constexpr CompressorInfo kCompressors[] = {
+    CTCS_PACK_COMPRESSOR("arithmetic", ctcs::ArithmeticCodingCompressor<ctcs::EnglishCharModel>),
+    CTCS_PACK_COMPRESSOR("range", ctcs::RangeCodingCompressor<ctcs::EnglishCharModel>),
+    CTCS_PACK_COMPRESSOR("interleaved", ctcs::InterleavedRangeCodingCompressor<ctcs::EnglishCharModel>),
+    CTCS_PACK_COMPRESSOR("huffman", ctcs::HuffmanCompressor<ctcs::EnglishCharModel>),
+    CTCS_PACK_COMPRESSOR("utf8", ctcs::ArithmeticCodingCompressor<ctcs::Utf8Model<>>),
+    CTCS_PACK_COMPRESSOR("lz", ctcs::LzCompressor<ctcs::AdaptiveCharModel>),
+    CTCS_PACK_COMPRESSOR("binary", ctcs::BinaryCompressor<>),
+  };
+
+#undef CTCS_PACK_COMPRESSOR
+
+  struct Options
+  {
+    const char* input = nullptr;
+    const char* output = nullptr;
+    std::string_view name;
+    std::string_view name_space;
+    const CompressorInfo* compressor = nullptr;
+    bool binary = false;
+    bool list_compressors = false;
+  };
+
+  const CompressorInfo* findCompressor(std::string_view name)
+  {
+    for (const CompressorInfo& compressor : kCompressors)
+    {
+      if (name == compressor.name)
+      {
+        return &compressor;
+      }
+    }
+    return nullptr;
+  }
+
+  // \return true if the given string is a valid C++ identifier (or a nested namespace name, if nested is true).
+  bool isIdentifier(std::string_view str, bool nested)
+  {
+    bool expect_start = true;
+    for (std::size_t i = 0; i < str.size(); ++i)
+    {
+      const char c = str[i];
+      if (nested && !expect_start && str.substr(i, 2) == "::")
+      {
+        expect_start = true;
+        ++i;
+        continue;
+      }
+      const bool is_letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+      const bool is_digit = (c >= '0' && c <= '9');
+      if (!is_letter && (expect_start || !is_digit))
+      {
+        return false;
+      }
+      expect_start = false;
+    }
+    return !expect_start;
+  }
+
+  std::string readFile(const char* path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+      throw std::runtime_error(std::string("cannot open ") + path);
+    }
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+
+  // Appends the given data as a sequence of adjacent string literals, one per line.
+  // Printable characters are written as is, the rest (and '?', which could start a trigraph) as
+  // 3-digit octal escape sequences, which can be followed by any character.
+  void appendStringLiteral(std::string& dest, std::string_view data, std::string_view indent)
+  {
+    constexpr std::size_t kMaxLineLength = 100;
+    dest.append(indent).push_back('"');
+    std::size_t line_length = indent.size() + 1;
+    for (std::size_t i = 0; i < data.size(); ++i)
+    {
+      if (line_length >= kMaxLineLength)
+      {
+        dest.append("\"\n").append(indent).push_back('"');
+        line_length = indent.size() + 1;
+      }
+      const unsigned char c = static_cast<unsigned char>(data[i]);
+      if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\' && c != '?')
+      {
+        dest.push_back(static_cast<char>(c));
+        line_length += 1;
+      }
+      else
+      {
+        const char escape[] = { '\\', static_cast<char>('0' + (c >> 6)), static_cast<char>('0' + ((c >> 3) & 7)),
+                                static_cast<char>('0' + (c & 7)) };
+        dest.append(escape, sizeof(escape));
+        line_length += sizeof(escape);
+      }
+    }
+    dest.push_back('"');
+  }
+
+  std::string generateHeader(const Options& options, std::string_view data, std::string_view compressed_data)
+  {
+    const std::string_view indent = options.name_space.empty() ? "" : "  ";
+    const std::string compressed_size = std::to_string(compressed_data.size());
+    const std::string decompressed_size = std::to_string(data.size());
+    std::string header;
+    header.append("// Generated by ctcs_pack from ").append(std::filesystem::path(options.input).filename().string())
+          .append(". Do not edit.\n");
+    header.append("// ").append(decompressed_size).append(" bytes compressed into ").append(compressed_size)
+          .append(" bytes with ").append(options.compressor->type_name).append(".\n");
+    header.append("#pragma once\n\n#include <ctcs/ctcs.h>\n\n");
+    if (!options.name_space.empty())
+    {
+      header.append("namespace ").append(options.name_space).append("\n{\n");
+    }
+    header.append(indent).append("inline constexpr ");
+    header.append(options.binary ? "ctcs::CompressedBytes<" : "ctcs::CompressedString<");
+    header.append(options.compressor->type_name).append("::Decompressor, ");
+    header.append(compressed_size).append(", ").append(decompressed_size);
+    header.append(options.binary ? ", unsigned char> " : "> ").append(options.name).append("(\n");
+    header.append(indent).append("  ctcs::StringLiteral<").append(compressed_size).append(">(\n");
+    appendStringLiteral(header, compressed_data, std::string(indent) + "    ");
+    header.append("));\n");
+    if (!options.name_space.empty())
+    {
+      header.append("}\n");
+    }
+    return header;
+  }
+
+  bool parseOptions(int argc, char* argv[], Options& options)
+  {
+    for (int i = 1; i < argc; ++i)
+    {
+      const std::string_view arg = argv[i];
+      const bool has_value = (i + 1 < argc);
+      if (arg == "--input" && has_value)
+      {
+        options.input = argv[++i];
+      }
+      else if (arg == "--output" && has_value)
+      {
+        options.output = argv[++i];
+      }
+      else if (arg == "--name" && has_value)
+      {
+        options.name = argv[++i];
+      }
+      else if (arg == "--namespace" && has_value)
+      {
+        options.name_space = argv[++i];
+      }
+      else if (arg == "--compressor" && has_value)
+      {
+        options.compressor = findCompressor(argv[++i]);
+        if (options.compressor == nullptr)
+        {
+          return false;
+        }
+      }
+      else if (arg == "--binary")
+      {
+        options.binary = true;
+      }
+      else if (arg == "--list-compressors")
+      {
+        options.list_compressors = true;
+      }
+      else
+      {
+        return false;
+      }
+    }
+    if (options.list_compressors)
+    {
+      return true;
+    }
+    if (options.compressor == nullptr)
+    {
+      options.compressor = options.binary ? &kCompressors[std::size(kCompressors) - 1] : &kCompressors[0];
+    }
+    return options.input != nullptr && options.output != nullptr && isIdentifier(options.name, false) &&
+           (options.name_space.empty() || isIdentifier(options.name_space, true));
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!parseOptions(argc, argv, options))
+  {
+    std::fprintf(stderr, "Usage: %s --input FILE --output HEADER --name IDENTIFIER [--namespace NAMESPACE] "
+                         "[--compressor NAME] [--binary]\n"
+                         "       %s --list-compressors\n", argv[0], argv[0]);
+    return 2;
+  }
+  if (options.list_compressors)
+  {
+    for (const CompressorInfo& compressor : kCompressors)
+    {
+      std::printf("%s\t%s\n", compressor.name, compressor.type_name);
+    }
+    return 0;
+  }
+  try
+  {
+    const std::string data = readFile(options.input);
+    const std::string compressed_data = options.compressor->compress(data);
+    // Never generate a header that doesn't decompress into the original file.
+    if (options.compressor->decompress(compressed_data, data.size()) != data)
+    {
+      std::fprintf(stderr, "ctcs_pack: %s failed to decompress %s.\n", options.compressor->type_name, options.input);
+      return 1;
+    }
+    const std::string header = generateHeader(options, data, compressed_data);
+    std::ofstream file(options.output, std::ios::binary);
+    if (!file.write(header.data(), static_cast<std::streamsize>(header.size())))
+    {
+      throw std::runtime_error(std::string("cannot write ") + options.output);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    std::fprintf(stderr, "ctcs_pack: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}